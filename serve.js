@@ -11,11 +11,29 @@ Bun.serve({
     const file = Bun.file('./web' + path);
     
     if (await file.exists()) {
-      return new Response(await file.arrayBuffer(), {
-        headers: {
-          'Content-Type': getContentType(path),
-        },
-      });
+      const headers = {
+        'Content-Type': getContentType(path),
+        'Accept-Ranges': 'bytes',
+        // Cross-origin isolation enables SharedArrayBuffer for the
+        // pthreads build (index_mt.js)
+        'Cross-Origin-Opener-Policy': 'same-origin',
+        'Cross-Origin-Embedder-Policy': 'require-corp',
+      };
+      
+      // Single byte ranges, used to page candle archive blocks (history.mca)
+      const range = /^bytes=(\d+)-(\d*)$/.exec(req.headers.get('Range') || '');
+      if (range) {
+        const start = Number(range[1]);
+        const end = range[2] ? Math.min(Number(range[2]), file.size - 1) : file.size - 1;
+        if (start > end) {
+          headers['Content-Range'] = `bytes */${file.size}`;
+          return new Response('Range not satisfiable', { status: 416, headers });
+        }
+        headers['Content-Range'] = `bytes ${start}-${end}/${file.size}`;
+        return new Response(file.slice(start, end + 1), { status: 206, headers });
+      }
+      
+      return new Response(await file.arrayBuffer(), { headers });
     }
     
     return new Response('Not found', { status: 404 });
@@ -32,6 +50,7 @@ function getContentType(path) {
     'wasm': 'application/wasm',
     'css': 'text/css; charset=utf-8',
     'json': 'application/json; charset=utf-8',
+    'csv': 'text/csv; charset=utf-8',
   };
   return types[ext] || 'application/octet-stream';
 }
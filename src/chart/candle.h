@@ -1,5 +1,8 @@
 #pragma once
 
+#include "../data/market_types.h"
+#include "../data/time_index.h"
+
 // ============================================================================
 // CANDLE DATA STRUCTURES
 // Represents OHLC (Open, High, Low, Close) candlestick data
@@ -7,76 +10,156 @@
 
 struct Candle
 {
-    float open;
-    float high;
-    float low;
-    float close;
+    TimeNs time;        // Open time of the candle's interval
+    PriceTicks open;
+    PriceTicks high;
+    PriceTicks low;
+    PriceTicks close;
     bool valid;
     
-    Candle() : open(0), high(0), low(0), close(0), valid(false) {}
-    Candle(float o, float h, float l, float c) 
-        : open(o), high(h), low(l), close(c), valid(true) {}
+    Candle() : time(0), open(0), high(0), low(0), close(0), valid(false) {}
+    Candle(TimeNs t, PriceTicks o, PriceTicks h, PriceTicks l, PriceTicks c)
+        : time(t), open(o), high(h), low(l), close(c), valid(true) {}
     
     bool isBullish() const { return close >= open; }
 };
 
+inline TimeNs timeOf(const Candle& candle) { return candle.time; }
+
 // ============================================================================
 // CANDLE BUFFER - Ring buffer for storing candle history
+// Appends, in-place corrections and structural changes (clear, backfill)
+// are tracked so copies can be brought up to date incrementally with
+// copyFrom(). Mutate only through the methods below; writing through get()
+// is not tracked. Capacity is set at runtime (memory budget) and copies
+// follow the source's capacity.
 // ============================================================================
 
-class CandleBuffer
+class CandleBuffer : public DynamicRingBuffer<Candle>
 {
 public:
-    static const int MAX_CANDLES = 100;
+    static const int MAX_CANDLES = 65536;  // Default capacity: ~18 hours of 1s, ~45 days of 1m candles
+    static const int CORRECTION_LOG = 64;  // Corrections a copy catches up on without a full copy
     
-    CandleBuffer() : m_count(0), m_start(0) {}
+    CandleBuffer() : DynamicRingBuffer<Candle>(MAX_CANDLES), m_revision(0), m_appended(0), m_corrected(0) {}
+    
+    int maxCandles() const { return capacity(); }
     
     void push(const Candle& candle)
     {
-        if (m_count < MAX_CANDLES)
+        DynamicRingBuffer::push(candle);
+        m_appended++;
+    }
+    
+    void clear()
+    {
+        DynamicRingBuffer::clear();
+        m_revision++;
+    }
+    
+    // Change capacity (rounded up to a power of two) keeping the newest candles
+    void setCapacity(int minCapacity)
+    {
+        int before = capacity();
+        resize(minCapacity);
+        if (capacity() != before) m_revision++;
+    }
+    
+    // Replace a finalized candle in place (late tick correction)
+    void correct(int index, const Candle& candle)
+    {
+        get(index) = candle;
+        m_correctionLog[m_corrected % CORRECTION_LOG] = (int64_t)m_appended - count() + index;
+        m_corrected++;
+    }
+    
+    // Prepend older, time-ordered candles (at the current interval) in front
+    // of the resident history; only candles opening before both the oldest
+    // resident candle and `before` are taken, up to the free capacity.
+    // Returns the number prepended.
+    int backfill(const Candle* candles, int n, TimeNs before)
+    {
+        int added = backfillTimeOrdered(*this, candles, n, before);
+        if (added > 0) m_revision++;
+        return added;
+    }
+    
+    // Make this buffer equal to source. When source only appended and
+    // corrected a few candles since the last copyFrom() (the common case: one
+    // candle per interval) just those candles are copied, otherwise
+    // everything is (reallocating when the source's capacity changed).
+    void copyFrom(const CandleBuffer& source)
+    {
+        uint64_t appended = source.m_appended - m_appended;
+        uint64_t corrected = source.m_corrected - m_corrected;
+        bool incremental = source.m_revision == m_revision && appended <= (uint64_t)source.count() &&
+                           corrected <= CORRECTION_LOG && source.capacity() == capacity();
+        RangeView<Candle> changed;
+        if (incremental)
         {
-            m_candles[m_count] = candle;
-            m_count++;
+            changed = source.view(source.count() - (int)appended, source.count());
         }
         else
         {
-            // Ring buffer full, overwrite oldest
-            m_candles[m_start] = candle;
-            m_start = (m_start + 1) % MAX_CANDLES;
+            if (source.capacity() != capacity())
+                reset(source.capacity());
+            else
+                DynamicRingBuffer::clear();
+            changed = source.segments();
         }
+        pushBulk(changed.spans[0].data, changed.spans[0].count);
+        pushBulk(changed.spans[1].data, changed.spans[1].count);
+        
+        // Corrected candles still resident (positions count appends)
+        if (incremental)
+        {
+            int64_t first = (int64_t)source.m_appended - source.count();
+            for (uint64_t c = m_corrected; c < source.m_corrected; c++)
+            {
+                int64_t index = source.m_correctionLog[c % CORRECTION_LOG] - first;
+                if (index >= 0 && index < source.count())
+                    get((int)index) = source.get((int)index);
+            }
+        }
+        
+        m_revision = source.m_revision;
+        m_appended = source.m_appended;
+        m_corrected = source.m_corrected;
     }
     
-    const Candle& get(int index) const
-    {
-        int actualIndex = (m_start + index) % MAX_CANDLES;
-        return m_candles[actualIndex];
-    }
-    
-    int count() const { return m_count; }
-    int maxCandles() const { return MAX_CANDLES; }
+    // Candles opening in [t0, t1), and the last n opening at or before t
+    // (O(log n), zero-copy; see time_index.h)
+    RangeView<Candle> queryRange(TimeNs t0, TimeNs t1) const { return queryTimeRange<Candle>(*this, t0, t1); }
+    RangeView<Candle> queryLast(int n, TimeNs t) const { return queryLastN<Candle>(*this, n, t); }
     
     // Calculate price range across all candles
-    void getPriceRange(float& minPrice, float& maxPrice) const
+    void getPriceRange(PriceTicks& minPrice, PriceTicks& maxPrice) const
     {
-        if (m_count == 0)
+        if (count() == 0)
         {
-            minPrice = maxPrice = 100.0f;
+            minPrice = maxPrice = 0;
             return;
         }
         
-        minPrice = m_candles[m_start].low;
-        maxPrice = m_candles[m_start].high;
+        minPrice = get(0).low;
+        maxPrice = get(0).high;
         
-        for (int i = 0; i < m_count; i++)
+        RangeView<Candle> all = segments();
+        for (int s = 0; s < 2; s++)
         {
-            const Candle& c = get(i);
-            if (c.low < minPrice) minPrice = c.low;
-            if (c.high > maxPrice) maxPrice = c.high;
+            const Span<Candle>& span = all.spans[s];
+            for (int i = 0; i < span.count; i++)
+            {
+                const Candle& c = span.data[i];
+                if (c.low < minPrice) minPrice = c.low;
+                if (c.high > maxPrice) maxPrice = c.high;
+            }
         }
     }
     
 private:
-    Candle m_candles[MAX_CANDLES];
-    int m_count;
-    int m_start;
+    uint64_t m_revision;    // Bumped by clear() and backfill()
+    uint64_t m_appended;    // Candles pushed since construction
+    uint64_t m_corrected;   // Corrections since construction
+    int64_t m_correctionLog[CORRECTION_LOG];  // Position (appends before it) of recent corrections
 };
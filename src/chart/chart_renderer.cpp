@@ -1,17 +1,33 @@
 #include "chart_renderer.h"
+#include "../kernels/price_kernels.h"
+#include "../data/candle_archive.h"
 #include <stdio.h>
 #include <math.h>
 
 ChartRenderer::ChartRenderer()
     : m_gridLines(5)
     , m_zoomLevel(1.0f)
-    , m_scrollOffset(1.0f)  // Start at the end (most recent candles)
+    , m_scrollBack(0)       // Start at the end (most recent candles)
+    , m_panRemainder(0.0f)
+    , m_lastVisibleCount(0)
+    , m_lastMaxStartIndex(0)
+    , m_lastCandleWidth(MIN_CANDLE_WIDTH)
+    , m_panDirection(-1)
+    , m_archive(nullptr)
     , m_hoveredCandleIndex(-1)
     , m_lastCanvasPos(0, 0)
     , m_lastCanvasSize(0, 0)
     , m_lastMinPrice(0)
     , m_lastPriceRange(1.0f)
 {
+    static const char* const componentNames[DRAW_COMPONENT_COUNT] = {
+        "Background", "Grid", "Candles", "Price Scale", "Price Line", "Crosshair", "Tooltip"
+    };
+    for (int i = 0; i < DRAW_COMPONENT_COUNT; i++)
+    {
+        m_drawStats[i] = {};
+        m_drawStats[i].name = componentNames[i];
+    }
 }
 
 // ============================================================================
@@ -33,7 +49,8 @@ void ChartRenderer::zoomOut()
 void ChartRenderer::resetZoom()
 {
     m_zoomLevel = 1.0f;
-    m_scrollOffset = 1.0f;  // Back to end
+    m_scrollBack = 0;       // Back to end
+    m_panRemainder = 0.0f;
 }
 
 void ChartRenderer::adjustZoom(float delta)
@@ -43,25 +60,53 @@ void ChartRenderer::adjustZoom(float delta)
     if (m_zoomLevel > MAX_ZOOM) m_zoomLevel = MAX_ZOOM;
 }
 
+// The scroll position is a candle count; the 0..1 fraction is derived from
+// it (a float fraction cannot address single candles in a long archive)
 void ChartRenderer::setScrollOffset(float offset)
 {
-    m_scrollOffset = offset;
-    if (m_scrollOffset < 0.0f) m_scrollOffset = 0.0f;
-    if (m_scrollOffset > 1.0f) m_scrollOffset = 1.0f;
+    if (offset < 0.0f) offset = 0.0f;
+    if (offset > 1.0f) offset = 1.0f;
+    scrollBackTo((int)((1.0 - offset) * m_lastMaxStartIndex + 0.5));
 }
 
-void ChartRenderer::render(const char* symbol,
-                           float currentPrice,
-                           const CandleBuffer& candleBuffer,
-                           const Candle& currentCandle,
-                           float ticksPerSecond,
-                           float candleInterval,
-                           float windowHeight)
+float ChartRenderer::getScrollOffset() const
+{
+    return m_lastMaxStartIndex > 0 ? 1.0f - (float)m_scrollBack / (float)m_lastMaxStartIndex : 1.0f;
+}
+
+void ChartRenderer::scrollBackTo(int scrollBack)
+{
+    if (scrollBack > m_lastMaxStartIndex) scrollBack = m_lastMaxStartIndex;
+    if (scrollBack < 0) scrollBack = 0;
+    
+    // Remember the pan direction for archive prefetch
+    if (scrollBack != m_scrollBack)
+        m_panDirection = scrollBack > m_scrollBack ? -1 : 1;
+    m_scrollBack = scrollBack;
+}
+
+// Pan by a number of candles (positive = towards newer candles); fractions
+// accumulate so slow drags still move
+void ChartRenderer::panCandles(float candles)
+{
+    m_panRemainder += candles;
+    int whole = (int)m_panRemainder;
+    m_panRemainder -= (float)whole;
+    scrollBackTo(m_scrollBack - whole);
+}
+
+void ChartRenderer::render(const char* symbol, const ChartSnapshot& snapshot, float windowHeight)
 {
     ImGuiIO& io = ImGui::GetIO();
     
-    // Reset hover state at start of frame
+    // Reset hover state and draw attribution at start of frame
     m_hoveredCandleIndex = -1;
+    for (int i = 0; i < DRAW_COMPONENT_COUNT; i++)
+    {
+        m_drawStats[i].vertices = 0;
+        m_drawStats[i].indices = 0;
+        m_drawStats[i].commands = 0;
+    }
     
     // Setup window
     ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
@@ -73,7 +118,7 @@ void ChartRenderer::render(const char* symbol,
     ImGui::Begin(windowTitle, nullptr, 
                  ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
     
-    renderHeader(symbol, currentPrice, candleBuffer, ticksPerSecond, candleInterval);
+    renderHeader(symbol, snapshot);
     
     ImGui::Separator();
     
@@ -96,10 +141,8 @@ void ChartRenderer::render(const char* symbol,
         {
             if (io.KeyShift)
             {
-                // Shift + scroll = horizontal pan
-                m_scrollOffset -= wheel * 0.05f;
-                if (m_scrollOffset < 0.0f) m_scrollOffset = 0.0f;
-                if (m_scrollOffset > 1.0f) m_scrollOffset = 1.0f;
+                // Shift + scroll = horizontal pan (a tenth of the view per notch)
+                panCandles(-wheel * m_lastVisibleCount * 0.1f);
             }
             else
             {
@@ -109,17 +152,14 @@ void ChartRenderer::render(const char* symbol,
         }
     }
     
-    // Handle drag to pan when zoomed in
-    if (isHovered && m_zoomLevel > 1.0f && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
+    // Handle drag to pan when there is history outside the view
+    if (isHovered && m_lastMaxStartIndex > 0 && ImGui::IsMouseDragging(ImGuiMouseButton_Left))
     {
         ImVec2 delta = ImGui::GetMouseDragDelta(ImGuiMouseButton_Left);
         if (delta.x != 0.0f)
         {
-            // Convert pixel drag to scroll offset
-            float dragSensitivity = 0.002f / m_zoomLevel;
-            m_scrollOffset -= delta.x * dragSensitivity;
-            if (m_scrollOffset < 0.0f) m_scrollOffset = 0.0f;
-            if (m_scrollOffset > 1.0f) m_scrollOffset = 1.0f;
+            // Candles follow the cursor
+            panCandles(-delta.x / m_lastCandleWidth);
             ImGui::ResetMouseDragDelta(ImGuiMouseButton_Left);
         }
     }
@@ -127,11 +167,14 @@ void ChartRenderer::render(const char* symbol,
     ImDrawList* drawList = ImGui::GetWindowDrawList();
     
     // Draw background
+    DrawListSample backgroundSample(drawList);
     drawList->AddRectFilled(canvasPos, 
                             ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y), 
                             m_colors.background);
+    backgroundSample.end(m_drawStats[DRAW_BACKGROUND]);
     
     // Draw grid
+    DrawListSample gridSample(drawList);
     for (int i = 1; i < m_gridLines; i++)
     {
         float y = canvasPos.y + canvasSize.y * i / m_gridLines;
@@ -139,29 +182,34 @@ void ChartRenderer::render(const char* symbol,
                          ImVec2(canvasPos.x + canvasSize.x, y), 
                          m_colors.grid);
     }
+    gridSample.end(m_drawStats[DRAW_GRID]);
     
     // Render candles and price elements (also handles hit detection)
-    renderCandles(drawList, canvasPos, canvasSize, candleBuffer, currentCandle, currentPrice, isHovered, mousePos);
+    renderCandles(drawList, canvasPos, canvasSize, snapshot, isHovered, mousePos);
     
     // Render crosshair if enabled and hovering
     if (m_settings.crosshairEnabled && isHovered)
     {
+        DrawListSample crosshairSample(drawList);
         renderCrosshair(drawList, canvasPos, canvasSize, mousePos, m_lastMinPrice, m_lastPriceRange);
+        crosshairSample.end(m_drawStats[DRAW_CROSSHAIR]);
     }
     
     // Render tooltip if enabled and hovering a candle
     if (m_settings.tooltipEnabled && m_hoveredCandleIndex >= 0)
     {
-        renderTooltip(m_hoveredCandle, m_hoveredCandleIndex);
+        renderTooltip(m_hoveredCandle, m_hoveredCandleIndex, snapshot.priceScale);
     }
     
     ImGui::End();
 }
 
-void ChartRenderer::renderHeader(const char* symbol, float currentPrice,
-                                  const CandleBuffer& candleBuffer,
-                                  float ticksPerSecond, float candleInterval)
+void ChartRenderer::renderHeader(const char* symbol, const ChartSnapshot& snapshot)
 {
+    const CandleBuffer& candleBuffer = snapshot.candles;
+    const PriceScale& scale = snapshot.priceScale;
+    float currentPrice = scale.toPrice(snapshot.currentPrice);
+    
     ImGuiIO& io = ImGui::GetIO();
     
     // Calculate price change
@@ -169,7 +217,7 @@ void ChartRenderer::renderHeader(const char* symbol, float currentPrice,
     float priceChangePct = 0.0f;
     if (candleBuffer.count() > 0)
     {
-        float openPrice = candleBuffer.get(0).open;
+        float openPrice = scale.toPrice(candleBuffer.get(0).open);
         priceChange = currentPrice - openPrice;
         priceChangePct = (priceChange / openPrice) * 100.0f;
     }
@@ -187,7 +235,14 @@ void ChartRenderer::renderHeader(const char* symbol, float currentPrice,
     ImGui::SameLine(420);
     ImGui::Text("Candles: %d", candleBuffer.count());
     ImGui::SameLine(520);
-    ImGui::Text("Ticks/s: %.0f", ticksPerSecond);
+    ImGui::Text("Ticks/s: %.0f", snapshot.ticksPerSecond);
+    
+    // Older candles of a new interval still filling in
+    if (snapshot.reaggregateProgress < 1.0f)
+    {
+        ImGui::SameLine(640);
+        ImGui::ProgressBar(snapshot.reaggregateProgress, ImVec2(160.0f, 0.0f), "Re-aggregating");
+    }
     
     // Second row: interval selector and toggles
     ImGui::Text("Interval:");
@@ -246,12 +301,94 @@ void ChartRenderer::renderHeader(const char* symbol, float currentPrice,
     ImGui::Checkbox("Tooltip", &m_settings.tooltipEnabled);
 }
 
+// ============================================================================
+// ARCHIVED HISTORY
+// ============================================================================
+
+int ChartRenderer::countArchived(const ChartSnapshot& snapshot)
+{
+    // The archive must match the live series' interval and price grid
+    if (!m_archive || !m_archive->isReady() ||
+        m_archive->getIntervalNs() != secondsToNs(snapshot.candleInterval) ||
+        m_archive->getTickSize() != snapshot.priceScale.tickSize)
+        return 0;
+    
+    m_archive->beginFrame();
+    
+    // Archived candles older than the oldest resident one
+    TimeNs residentStart = snapshot.candles.count() > 0 ? snapshot.candles.get(0).time : snapshot.currentCandle.time;
+    int64_t count = m_archive->countBefore(residentStart);
+    return count < MAX_ARCHIVED ? (int)count : MAX_ARCHIVED;
+}
+
+void ChartRenderer::collectVisible(const ChartSnapshot& snapshot, int archiveCount, int begin, int end)
+{
+    m_visibleSpans.resize(0);
+    int i = begin;
+    
+    // Archive blocks; missing ones are requested and stay empty this frame
+    if (i < archiveCount)
+    {
+        int blockSize = m_archive->getBlockSize();
+        while (i < end && i < archiveCount)
+        {
+            int block = i / blockSize;
+            int blockStart = block * blockSize;
+            int spanEnd = blockStart + blockSize;
+            if (spanEnd > archiveCount) spanEnd = archiveCount;
+            if (spanEnd > end) spanEnd = end;
+            
+            const Candle* candles = m_archive->getBlock(block);
+            VisibleSpan span = { candles ? candles + (i - blockStart) : nullptr, i, spanEnd - i };
+            m_visibleSpans.push_back(span);
+            i = spanEnd;
+        }
+    }
+    
+    // Prefetch one screen ahead in the direction of the last pan
+    if (archiveCount > 0)
+    {
+        int ahead = m_panDirection < 0 ? begin - (end - begin) : end + (end - begin);
+        if (ahead >= 0 && ahead < archiveCount)
+            m_archive->prefetch(ahead / m_archive->getBlockSize());
+    }
+    
+    // Resident candles (up to two ring spans)
+    const CandleBuffer& candleBuffer = snapshot.candles;
+    int residentEnd = archiveCount + candleBuffer.count();
+    if (i < end && i < residentEnd)
+    {
+        RangeView<Candle> resident = candleBuffer.view(i - archiveCount, (end < residentEnd ? end : residentEnd) - archiveCount);
+        for (int s = 0; s < 2; s++)
+        {
+            if (resident.spans[s].count == 0) continue;
+            VisibleSpan span = { resident.spans[s].data, i, resident.spans[s].count };
+            m_visibleSpans.push_back(span);
+            i += resident.spans[s].count;
+        }
+    }
+    
+    // Current forming candle
+    if (i < end && snapshot.currentCandle.valid)
+    {
+        VisibleSpan span = { &snapshot.currentCandle, i, 1 };
+        m_visibleSpans.push_back(span);
+    }
+}
+
 void ChartRenderer::renderCandles(ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize,
-                                   const CandleBuffer& candleBuffer, const Candle& currentCandle,
-                                   float currentPrice, bool isHovered, ImVec2 mousePos)
+                                   const ChartSnapshot& snapshot, bool isHovered, ImVec2 mousePos)
 {
+    const CandleBuffer& candleBuffer = snapshot.candles;
+    const Candle& currentCandle = snapshot.currentCandle;
+    double tickSize = snapshot.priceScale.tickSize;
+    float currentPrice = snapshot.priceScale.toPrice(snapshot.currentPrice);
+    
+    // Archived candles (on disk) precede the resident ones
+    int archiveCount = countArchived(snapshot);
+    
     // Total candles including current forming candle
-    int totalCandles = candleBuffer.count() + (currentCandle.valid ? 1 : 0);
+    int totalCandles = archiveCount + candleBuffer.count() + (currentCandle.valid ? 1 : 0);
     if (totalCandles == 0)
     {
         // No candles to render
@@ -259,41 +396,45 @@ void ChartRenderer::renderCandles(ImDrawList* drawList, ImVec2 canvasPos, ImVec2
         m_lastCanvasSize = canvasSize;
         m_lastMinPrice = currentPrice - 1.0f;
         m_lastPriceRange = 2.0f;
+        m_lastMaxStartIndex = 0;
         return;
     }
     
-    // Calculate visible candle range based on zoom
-    int visibleCount = (int)(totalCandles / m_zoomLevel);
+    // Calculate visible candle range based on zoom, relative to what fits
+    // the canvas at the minimum candle width (long histories scroll)
+    int fitCount = (int)((canvasSize.x - 70.0f) / MIN_CANDLE_WIDTH);
+    int baseCount = totalCandles < fitCount ? totalCandles : fitCount;
+    int visibleCount = (int)(baseCount / m_zoomLevel);
+    if (visibleCount > baseCount) visibleCount = baseCount;
     if (visibleCount < 1) visibleCount = 1;
-    if (visibleCount > totalCandles) visibleCount = totalCandles;
     
-    // Calculate start index based on scroll offset
+    // Calculate start index back from the newest candle
     int maxStartIndex = totalCandles - visibleCount;
     if (maxStartIndex < 0) maxStartIndex = 0;
-    int startIndex = (int)(m_scrollOffset * maxStartIndex);
+    if (m_scrollBack > maxStartIndex) m_scrollBack = maxStartIndex;
+    int startIndex = maxStartIndex - m_scrollBack;
     int endIndex = startIndex + visibleCount;
     if (endIndex > totalCandles) endIndex = totalCandles;
     
-    // Calculate price range only for visible candles
-    float minPrice = currentPrice;
-    float maxPrice = currentPrice;
+    // Contiguous runs of visible candles: archive blocks, the ring's spans
+    // and the forming candle
+    collectVisible(snapshot, archiveCount, startIndex, endIndex);
     
-    for (int i = startIndex; i < endIndex; i++)
+    // Calculate price range only for visible candles (in price ticks)
+    PriceTicks minTicks = snapshot.currentPrice;
+    PriceTicks maxTicks = snapshot.currentPrice;
+    int loadedCount = 0;
+    for (int s = 0; s < m_visibleSpans.Size; s++)
     {
-        if (i < candleBuffer.count())
-        {
-            const Candle& c = candleBuffer.get(i);
-            if (c.low < minPrice) minPrice = c.low;
-            if (c.high > maxPrice) maxPrice = c.high;
-        }
-        else if (currentCandle.valid)
-        {
-            // Current forming candle
-            if (currentCandle.low < minPrice) minPrice = currentCandle.low;
-            if (currentCandle.high > maxPrice) maxPrice = currentCandle.high;
-        }
+        const VisibleSpan& span = m_visibleSpans[s];
+        if (!span.data) continue;
+        priceRange(span.data, span.count, minTicks, maxTicks);
+        loadedCount += span.count;
     }
     
+    float minPrice = snapshot.priceScale.toPrice(minTicks);
+    float maxPrice = snapshot.priceScale.toPrice(maxTicks);
+    
     // Add padding
     float priceRange = maxPrice - minPrice;
     if (priceRange < 1.0f) priceRange = 1.0f;
@@ -311,69 +452,100 @@ void ChartRenderer::renderCandles(ImDrawList* drawList, ImVec2 canvasPos, ImVec2
     // Calculate candle dimensions based on visible count
     float candleWidth = (canvasSize.x - 70.0f) / (float)visibleCount;
     if (candleWidth > 40.0f) candleWidth = 40.0f;
-    if (candleWidth < 3.0f) candleWidth = 3.0f;
+    if (candleWidth < MIN_CANDLE_WIDTH) candleWidth = MIN_CANDLE_WIDTH;
     float bodyWidth = candleWidth * 0.7f;
     
-    // Price to Y coordinate helper
-    auto priceToY = [&](float price) -> float {
-        return canvasPos.y + canvasSize.y - ((price - minPrice) / priceRange) * canvasSize.y;
-    };
+    m_lastVisibleCount = visibleCount;
+    m_lastMaxStartIndex = maxStartIndex;
+    m_lastCandleWidth = candleWidth;
+    
+    // Price tick to Y coordinate transform
+    PriceTransform transform;
+    transform.minTicks = (float)(minPrice / tickSize);
+    transform.scale = (float)(canvasSize.y * tickSize / priceRange);
+    transform.baseY = canvasPos.y + canvasSize.y;
+    
+    // Batch-transform OHLC of all visible loaded candles (4 Ys per candle)
+    m_candleY.resize(loadedCount * 4);
+    float* spanY = m_candleY.Data;
+    for (int s = 0; s < m_visibleSpans.Size; s++)
+    {
+        const VisibleSpan& span = m_visibleSpans[s];
+        if (!span.data) continue;
+        candlesToY(span.data, span.count, transform, spanY);
+        spanY += span.count * 4;
+    }
     
     float xOffset = canvasPos.x + 10.0f;
     
-    // Draw visible candles
-    for (int i = startIndex; i < endIndex; i++)
+    // Draw visible candles (archive blocks still loading leave a gap)
+    DrawListSample candleSample(drawList);
+    const float* y = m_candleY.Data;
+    for (int s = 0; s < m_visibleSpans.Size; s++)
     {
-        int displayIndex = i - startIndex;  // Position in visible area
-        float x = xOffset + displayIndex * candleWidth + candleWidth * 0.5f;
-        
-        bool isCurrentCandle = (i >= candleBuffer.count());
-        const Candle& c = isCurrentCandle ? currentCandle : candleBuffer.get(i);
-        
-        if (!c.valid) continue;
-        
-        float yHigh = priceToY(c.high);
-        float yLow = priceToY(c.low);
-        float yOpen = priceToY(c.open);
-        float yClose = priceToY(c.close);
-        
-        bool bullish = c.isBullish();
-        ImU32 color;
-        if (isCurrentCandle)
-            color = bullish ? m_colors.bullishLive : m_colors.bearishLive;
-        else
-            color = bullish ? m_colors.bullish : m_colors.bearish;
+        const VisibleSpan& span = m_visibleSpans[s];
+        if (!span.data) continue;
+        bool isCurrentCandle = (span.data == &currentCandle);
         
-        // Hit detection for this candle
-        if (isHovered)
+        for (int j = 0; j < span.count; j++, y += 4)
         {
-            float candleLeft = x - candleWidth * 0.5f;
-            float candleRight = x + candleWidth * 0.5f;
-            if (mousePos.x >= candleLeft && mousePos.x <= candleRight)
+            int i = span.first + j;
+            int displayIndex = i - startIndex;  // Position in visible area
+            float x = xOffset + displayIndex * candleWidth + candleWidth * 0.5f;
+            
+            const Candle& c = span.data[j];
+            if (!c.valid) continue;
+            
+            float yOpen = y[0];
+            float yHigh = y[1];
+            float yLow = y[2];
+            float yClose = y[3];
+            
+            bool bullish = c.isBullish();
+            ImU32 color;
+            if (isCurrentCandle)
+                color = bullish ? m_colors.bullishLive : m_colors.bearishLive;
+            else
+                color = bullish ? m_colors.bullish : m_colors.bearish;
+            
+            // Hit detection for this candle
+            if (isHovered)
             {
-                m_hoveredCandleIndex = i;
-                m_hoveredCandle = c;
+                float candleLeft = x - candleWidth * 0.5f;
+                float candleRight = x + candleWidth * 0.5f;
+                if (mousePos.x >= candleLeft && mousePos.x <= candleRight)
+                {
+                    m_hoveredCandleIndex = i;
+                    m_hoveredCandle = c;
+                }
             }
+            
+            // Wick
+            drawList->AddLine(ImVec2(x, yHigh), ImVec2(x, yLow), color, 1.0f);
+            
+            // Body
+            float bodyTop = bullish ? yClose : yOpen;
+            float bodyBottom = bullish ? yOpen : yClose;
+            if (bodyBottom - bodyTop < 1.0f) bodyBottom = bodyTop + 1.0f;
+            
+            drawList->AddRectFilled(
+                ImVec2(x - bodyWidth * 0.5f, bodyTop),
+                ImVec2(x + bodyWidth * 0.5f, bodyBottom),
+                color
+            );
         }
-        
-        // Wick
-        drawList->AddLine(ImVec2(x, yHigh), ImVec2(x, yLow), color, 1.0f);
-        
-        // Body
-        float bodyTop = bullish ? yClose : yOpen;
-        float bodyBottom = bullish ? yOpen : yClose;
-        if (bodyBottom - bodyTop < 1.0f) bodyBottom = bodyTop + 1.0f;
-        
-        drawList->AddRectFilled(
-            ImVec2(x - bodyWidth * 0.5f, bodyTop),
-            ImVec2(x + bodyWidth * 0.5f, bodyBottom),
-            color
-        );
     }
     
+    candleSample.end(m_drawStats[DRAW_CANDLES]);
+    
     // Render price scale and current price line
+    DrawListSample scaleSample(drawList);
     renderPriceScale(drawList, canvasPos, canvasSize, minPrice, maxPrice);
+    scaleSample.end(m_drawStats[DRAW_PRICE_SCALE]);
+    
+    DrawListSample priceLineSample(drawList);
     renderCurrentPriceLine(drawList, canvasPos, canvasSize, currentPrice, minPrice, priceRange);
+    priceLineSample.end(m_drawStats[DRAW_PRICE_LINE]);
 }
 
 void ChartRenderer::renderPriceScale(ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize,
@@ -497,38 +669,48 @@ void ChartRenderer::renderCrosshair(ImDrawList* drawList, ImVec2 canvasPos, ImVe
     );
 }
 
-void ChartRenderer::renderTooltip(const Candle& candle, int candleIndex)
+void ChartRenderer::renderTooltip(const Candle& candle, int candleIndex, const PriceScale& scale)
 {
     ImGui::BeginTooltip();
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(8, 4));
     
-    // Title with candle index
+    // Tooltip draws into its own window's draw list
+    DrawListSample tooltipSample(ImGui::GetWindowDrawList());
+    
+    // Title with candle index and open time (data clock, h:mm:ss; backfilled
+    // history predates the session start and shows as negative)
     if (candleIndex >= 0)
     {
-        ImGui::Text("Candle #%d", candleIndex + 1);
+        long long t = (long long)(candle.time / NS_PER_SECOND);
+        long long seconds = t < 0 ? -t : t;
+        ImGui::Text("Candle #%d  %s%lld:%02d:%02d", candleIndex + 1, t < 0 ? "-" : "",
+                    seconds / 3600, (int)(seconds / 60 % 60), (int)(seconds % 60));
         ImGui::Separator();
     }
     
+    float open = scale.toPrice(candle.open);
+    float close = scale.toPrice(candle.close);
+    
     // OHLC data with colors
     ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Open:");
     ImGui::SameLine(60);
-    ImGui::Text("$%.2f", candle.open);
+    ImGui::Text("$%.2f", scale.toPrice(candle.open));
     
     ImGui::TextColored(ImVec4(0.2f, 0.9f, 0.2f, 1.0f), "High:");
     ImGui::SameLine(60);
-    ImGui::Text("$%.2f", candle.high);
+    ImGui::Text("$%.2f", scale.toPrice(candle.high));
     
     ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "Low:");
     ImGui::SameLine(60);
-    ImGui::Text("$%.2f", candle.low);
+    ImGui::Text("$%.2f", scale.toPrice(candle.low));
     
     ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Close:");
     ImGui::SameLine(60);
-    ImGui::Text("$%.2f", candle.close);
+    ImGui::Text("$%.2f", scale.toPrice(candle.close));
     
     // Show change
-    float change = candle.close - candle.open;
-    float changePct = (candle.open > 0) ? (change / candle.open * 100.0f) : 0.0f;
+    float change = close - open;
+    float changePct = (open > 0) ? (change / open * 100.0f) : 0.0f;
     
     ImGui::Separator();
     if (change >= 0)
@@ -536,6 +718,7 @@ void ChartRenderer::renderTooltip(const Candle& candle, int candleIndex)
     else
         ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "Change: %.2f (%.2f%%)", change, changePct);
     
+    tooltipSample.end(m_drawStats[DRAW_TOOLTIP]);
     ImGui::PopStyleVar();
     ImGui::EndTooltip();
 }
@@ -2,6 +2,10 @@
 
 #include "imgui.h"
 #include "candle.h"
+#include "chart_snapshot.h"
+#include "../perf/draw_stats.h"
+
+class CandleArchive;
 
 // ============================================================================
 // CHART RENDERER
@@ -16,10 +20,25 @@ public:
     static constexpr float INTERVALS[NUM_INTERVALS] = {1.0f, 30.0f, 60.0f, 300.0f};
     static constexpr const char* INTERVAL_LABELS[NUM_INTERVALS] = {"1s", "30s", "1m", "5m"};
     
+    // Draw components tracked for vertex/command attribution
+    enum DrawComponent
+    {
+        DRAW_BACKGROUND,
+        DRAW_GRID,
+        DRAW_CANDLES,
+        DRAW_PRICE_SCALE,
+        DRAW_PRICE_LINE,
+        DRAW_CROSSHAIR,
+        DRAW_TOOLTIP,
+        DRAW_COMPONENT_COUNT
+    };
+    
     // Zoom constants
     static constexpr float MIN_ZOOM = 0.5f;    // Show 2x more candles
     static constexpr float MAX_ZOOM = 10.0f;   // Show 10x fewer candles
     static constexpr float ZOOM_STEP = 0.15f;  // Zoom increment per scroll
+    static constexpr float MIN_CANDLE_WIDTH = 3.0f;  // Caps visible candles to what fits the canvas
+    static constexpr int MAX_ARCHIVED = 1 << 30;     // Archived candles addressable by scrolling
     
     // Settings for toggleable features
     struct Settings
@@ -69,19 +88,17 @@ public:
     
     ChartRenderer();
     
-    // Render the chart window
-    void render(const char* symbol,
-                float currentPrice,
-                const CandleBuffer& candleBuffer,
-                const Candle& currentCandle,
-                float ticksPerSecond,
-                float candleInterval,
-                float windowHeight);
+    // Render the chart window from one published snapshot
+    void render(const char* symbol, const ChartSnapshot& snapshot, float windowHeight);
     
     // Customization
     void setColors(const Colors& colors) { m_colors = colors; }
     void setGridLines(int lines) { m_gridLines = lines; }
     
+    // On-disk history shown when panning past the resident candles (not
+    // owned; used when its interval and tick size match the live series)
+    void setArchive(CandleArchive* archive) { m_archive = archive; }
+    
     // Feature toggles
     void setCrosshairEnabled(bool enabled) { m_settings.crosshairEnabled = enabled; }
     void setTooltipEnabled(bool enabled) { m_settings.tooltipEnabled = enabled; }
@@ -94,9 +111,12 @@ public:
     void zoomOut();
     void resetZoom();
     void adjustZoom(float delta);
-    void setScrollOffset(float offset);
+    void setScrollOffset(float offset);     // 0.0 = oldest, 1.0 = newest (as of the last render)
     float getZoomLevel() const { return m_zoomLevel; }
-    float getScrollOffset() const { return m_scrollOffset; }
+    float getScrollOffset() const;
+    
+    // Geometry emitted per component during the last render()
+    const DrawComponentStats* getDrawStats() const { return m_drawStats; }
     
 private:
     Colors m_colors;
@@ -105,7 +125,26 @@ private:
     
     // Zoom state
     float m_zoomLevel;      // 1.0 = default, 2.0 = 2x zoom (fewer candles), etc.
-    float m_scrollOffset;   // Horizontal scroll position (0.0 = start, 1.0 = end)
+    int m_scrollBack;       // Candles the view is scrolled back from the newest (0 = at the end)
+    float m_panRemainder;   // Part of a candle panned but not yet scrolled
+    
+    // Visible window of the last render (pans are in candles, not offset)
+    int m_lastVisibleCount;
+    int m_lastMaxStartIndex;
+    float m_lastCandleWidth;
+    int m_panDirection;     // -1 = towards older candles, 1 = towards newer
+    
+    CandleArchive* m_archive;
+    
+    // Visible candles as contiguous runs (data == nullptr: archive block
+    // still loading), rebuilt every frame
+    struct VisibleSpan
+    {
+        const Candle* data;
+        int first;          // Index of data[0] on the archive + resident timeline
+        int count;
+    };
+    ImVector<VisibleSpan> m_visibleSpans;
     
     // Hover state tracking
     int m_hoveredCandleIndex;
@@ -115,13 +154,20 @@ private:
     float m_lastMinPrice;
     float m_lastPriceRange;
     
-    void renderHeader(const char* symbol, float currentPrice, 
-                      const CandleBuffer& candleBuffer,
-                      float ticksPerSecond, float candleInterval);
+    // Scratch buffer for batch price -> Y transforms (reused across frames)
+    ImVector<float> m_candleY;
+    
+    // Per-component draw attribution
+    DrawComponentStats m_drawStats[DRAW_COMPONENT_COUNT];
+    
+    void panCandles(float candles);
+    void scrollBackTo(int scrollBack);
+    int countArchived(const ChartSnapshot& snapshot);
+    void collectVisible(const ChartSnapshot& snapshot, int archiveCount, int begin, int end);
+    void renderHeader(const char* symbol, const ChartSnapshot& snapshot);
     
     void renderCandles(ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize,
-                       const CandleBuffer& candleBuffer, const Candle& currentCandle,
-                       float currentPrice, bool isHovered, ImVec2 mousePos);
+                       const ChartSnapshot& snapshot, bool isHovered, ImVec2 mousePos);
     
     void renderPriceScale(ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize,
                           float minPrice, float maxPrice);
@@ -132,7 +178,7 @@ private:
     void renderCrosshair(ImDrawList* drawList, ImVec2 canvasPos, ImVec2 canvasSize,
                          ImVec2 mousePos, float minPrice, float priceRange);
     
-    void renderTooltip(const Candle& candle, int candleIndex);
+    void renderTooltip(const Candle& candle, int candleIndex, const PriceScale& scale);
     
     // Helper for drawing dotted lines
     void drawDottedLine(ImDrawList* drawList, ImVec2 p1, ImVec2 p2, ImU32 color, 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "candle.h"
+#include <stdint.h>
+
+// ============================================================================
+// CHART SNAPSHOT
+// Immutable view of everything the chart draws in one frame, published once
+// per aggregation step by the data pipeline. The renderer, tooltips and
+// exporters all read the same snapshot during a frame.
+// ============================================================================
+
+struct ChartSnapshot
+{
+    static const int MAX_STAMPS = 256;  // Ingest stamps carried per snapshot
+    
+    uint64_t sequence;      // Publication number (0 = nothing published yet)
+    CandleBuffer candles;
+    Candle currentCandle;
+    PriceTicks currentPrice;
+    PriceScale priceScale;  // Converts the integer prices above for display
+    float candleInterval;
+    float ticksPerSecond;
+    float reaggregateProgress;  // Interval change filling in older candles (1 = complete)
+    
+    // Ingest stamps of ticks this snapshot makes visible for the first time
+    // (includes ticks of earlier snapshots the reader never adopted)
+    double ingestStamps[MAX_STAMPS];
+    int ingestStampCount;
+    
+    ChartSnapshot()
+        : sequence(0)
+        , currentPrice(0)
+        , candleInterval(1.0f)
+        , ticksPerSecond(0.0f)
+        , reaggregateProgress(1.0f)
+        , ingestStampCount(0)
+    {}
+};
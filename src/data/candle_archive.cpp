@@ -0,0 +1,438 @@
+#include "candle_archive.h"
+#include <stdio.h>
+#include <string.h>
+
+// Column bytes per candle: time (int64) + open, high, low, close (int32)
+static const uint32_t CANDLE_BYTES = sizeof(int64_t) + 4 * sizeof(int32_t);
+
+// Upper bound on index size accepted from a file (sanity check)
+static const uint32_t MAX_BLOCKS = 1u << 24;
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+bool writeCandleArchive(const char* path, const Candle* candles, int64_t count,
+                        TimeNs intervalNs, double tickSize, int blockSize)
+{
+    if (count <= 0 || blockSize <= 0)
+        return false;
+    
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+    
+    ArchiveHeader header = {};
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.blockSize = (uint32_t)blockSize;
+    header.blockCount = (uint32_t)((count + blockSize - 1) / blockSize);
+    header.candleCount = count;
+    header.intervalNs = intervalNs;
+    header.tickSize = tickSize;
+    header.indexOffset = sizeof(ArchiveHeader);
+    
+    // Block data follows the index, blocks back to back
+    std::vector<ArchiveBlock> index(header.blockCount);
+    uint64_t offset = header.indexOffset + sizeof(ArchiveBlock) * index.size();
+    for (uint32_t b = 0; b < header.blockCount; b++)
+    {
+        int64_t first = (int64_t)b * blockSize;
+        int64_t n = count - first < blockSize ? count - first : blockSize;
+        index[b].firstTime = candles[first].time;
+        index[b].lastTime = candles[first + n - 1].time;
+        index[b].offset = offset;
+        index[b].count = (uint32_t)n;
+        index[b].bytes = (uint32_t)n * CANDLE_BYTES;
+        offset += index[b].bytes;
+    }
+    
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(index.data(), sizeof(ArchiveBlock), index.size(), file);
+    
+    // Columns of each block
+    std::vector<int64_t> times(blockSize);
+    std::vector<int32_t> prices(blockSize);
+    for (uint32_t b = 0; b < header.blockCount; b++)
+    {
+        const Candle* block = candles + (int64_t)b * blockSize;
+        int n = (int)index[b].count;
+        
+        for (int i = 0; i < n; i++) times[i] = block[i].time;
+        fwrite(times.data(), sizeof(int64_t), n, file);
+        for (int i = 0; i < n; i++) prices[i] = block[i].open;
+        fwrite(prices.data(), sizeof(int32_t), n, file);
+        for (int i = 0; i < n; i++) prices[i] = block[i].high;
+        fwrite(prices.data(), sizeof(int32_t), n, file);
+        for (int i = 0; i < n; i++) prices[i] = block[i].low;
+        fwrite(prices.data(), sizeof(int32_t), n, file);
+        for (int i = 0; i < n; i++) prices[i] = block[i].close;
+        fwrite(prices.data(), sizeof(int32_t), n, file);
+    }
+    
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+CandleArchive::CandleArchive()
+    : m_state(STATE_CLOSED)
+    , m_file(nullptr)
+    , m_header()
+    , m_cacheBlocks(CACHE_BLOCKS)
+    , m_cacheLimit(MemoryBudget::UNLIMITED)
+    , m_frame(1)
+    , m_loadsInFlight(0)
+{
+    for (int i = 0; i < CACHE_BLOCKS; i++)
+    {
+        m_slots[i].owner = this;
+        m_slots[i].block = -1;
+        m_slots[i].lastUsed = 0;
+        m_slots[i].loading = false;
+    }
+    
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_blocksLoaded = metrics.counter("archive.blocks_loaded");
+    m_blockMisses = metrics.counter("archive.block_misses");
+    m_loadErrors = metrics.counter("archive.load_errors");
+    m_bytesRead = metrics.counter("archive.bytes_read");
+    m_residentBlocks = metrics.gauge("archive.resident_blocks");
+}
+
+CandleArchive::~CandleArchive()
+{
+    close();
+}
+
+bool CandleArchive::open(const char* path)
+{
+    close();
+    
+    m_file = platformFileOpen(path);
+    if (!m_file)
+    {
+        m_state = STATE_FAILED;
+        return false;
+    }
+    
+    // Header, then index; both callbacks run inside this call natively
+    m_state = STATE_OPENING;
+    platformFileRead(m_file, 0, sizeof(ArchiveHeader), onHeaderRead, this);
+    return m_state != STATE_FAILED;
+}
+
+void CandleArchive::close()
+{
+    platformFileClose(m_file);
+    m_file = nullptr;
+    m_state = STATE_CLOSED;
+    m_header = ArchiveHeader();
+    m_blocks.clear();
+    std::vector<Candle>().swap(m_cache);
+    for (int i = 0; i < CACHE_BLOCKS; i++)
+    {
+        m_slots[i].block = -1;
+        m_slots[i].loading = false;
+    }
+    m_loadsInFlight = 0;
+    m_residentBlocks->set(0);
+}
+
+void CandleArchive::onHeaderRead(void* user, const void* data, size_t size)
+{
+    CandleArchive* archive = (CandleArchive*)user;
+    ArchiveHeader header;
+    if (!data || size != sizeof(header))
+    {
+        archive->m_state = STATE_FAILED;
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    
+    if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION ||
+        header.blockSize == 0 || header.blockCount == 0 || header.blockCount > MAX_BLOCKS ||
+        header.candleCount > (int64_t)header.blockSize * header.blockCount)
+    {
+        archive->m_state = STATE_FAILED;
+        return;
+    }
+    
+    archive->m_header = header;
+    platformFileRead(archive->m_file, header.indexOffset, sizeof(ArchiveBlock) * header.blockCount, onIndexRead, archive);
+}
+
+void CandleArchive::onIndexRead(void* user, const void* data, size_t size)
+{
+    CandleArchive* archive = (CandleArchive*)user;
+    uint32_t blockCount = archive->m_header.blockCount;
+    if (!data || size != sizeof(ArchiveBlock) * blockCount)
+    {
+        archive->m_state = STATE_FAILED;
+        return;
+    }
+    
+    archive->m_blocks.resize(blockCount);
+    memcpy(archive->m_blocks.data(), data, size);
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        const ArchiveBlock& block = archive->m_blocks[b];
+        if (block.count > archive->m_header.blockSize || block.bytes != block.count * CANDLE_BYTES)
+        {
+            archive->m_state = STATE_FAILED;
+            return;
+        }
+    }
+    
+    archive->m_cacheBlocks = archive->cacheBlocksFor(archive->m_cacheLimit);
+    archive->m_cache.assign((size_t)archive->m_cacheBlocks * archive->m_header.blockSize, Candle());
+    archive->m_state = STATE_READY;
+}
+
+void CandleArchive::onBlockRead(void* user, const void* data, size_t size)
+{
+    Slot* slot = (Slot*)user;
+    CandleArchive* archive = slot->owner;
+    const ArchiveBlock& block = archive->m_blocks[slot->block];
+    archive->m_loadsInFlight--;
+    slot->loading = false;
+    
+    if (!data || size != block.bytes)
+    {
+        // Slot freed; the block is requested again when next needed
+        slot->block = -1;
+        archive->m_loadErrors->add();
+        return;
+    }
+    
+    // Columns -> candles
+    int n = (int)block.count;
+    const int64_t* times = (const int64_t*)data;
+    const int32_t* opens = (const int32_t*)(times + n);
+    const int32_t* highs = opens + n;
+    const int32_t* lows = highs + n;
+    const int32_t* closes = lows + n;
+    
+    Candle* candles = &archive->m_cache[(size_t)(slot - archive->m_slots) * archive->m_header.blockSize];
+    for (int i = 0; i < n; i++)
+    {
+        candles[i] = Candle(times[i], opens[i], highs[i], lows[i], closes[i]);
+    }
+    
+    archive->m_blocksLoaded->add();
+    archive->m_bytesRead->add(size);
+    archive->updateResident();
+}
+
+int CandleArchive::findSlot(int block) const
+{
+    for (int i = 0; i < m_cacheBlocks; i++)
+    {
+        if (m_slots[i].block == block)
+            return i;
+    }
+    return -1;
+}
+
+int CandleArchive::startLoad(int block)
+{
+    if (m_loadsInFlight >= MAX_LOADS_IN_FLIGHT)
+        return -1;
+    
+    // An empty slot, else the least recently used one not needed this frame
+    int victim = -1;
+    for (int i = 0; i < m_cacheBlocks; i++)
+    {
+        const Slot& slot = m_slots[i];
+        if (slot.loading)
+            continue;
+        if (slot.block < 0)
+        {
+            victim = i;
+            break;
+        }
+        if (slot.lastUsed < m_frame && (victim < 0 || slot.lastUsed < m_slots[victim].lastUsed))
+            victim = i;
+    }
+    if (victim < 0)
+        return -1;
+    
+    Slot& slot = m_slots[victim];
+    slot.block = block;
+    slot.lastUsed = m_frame;
+    slot.loading = true;
+    m_loadsInFlight++;
+    
+    const ArchiveBlock& entry = m_blocks[block];
+    platformFileRead(m_file, entry.offset, entry.bytes, onBlockRead, &slot);
+    return victim;
+}
+
+void CandleArchive::updateResident()
+{
+    int resident = 0;
+    for (int i = 0; i < m_cacheBlocks; i++)
+    {
+        if (m_slots[i].block >= 0 && !m_slots[i].loading)
+            resident++;
+    }
+    m_residentBlocks->set(resident);
+}
+
+void CandleArchive::beginFrame()
+{
+    m_frame++;
+    resizeCache();
+}
+
+size_t CandleArchive::getMemoryUsage() const
+{
+    return m_cache.capacity() * sizeof(Candle);
+}
+
+void CandleArchive::registerMemory(MemoryBudget& budget)
+{
+    // Floor at the default block size (the archive may not be open yet)
+    size_t floorBytes = (size_t)MIN_CACHE_BLOCKS * 4096 * sizeof(Candle);
+    budget.add("archive.cache", MEMORY_CACHE, floorBytes, cacheUsage, limitCache, this);
+}
+
+size_t CandleArchive::cacheUsage(void* user)
+{
+    return ((const CandleArchive*)user)->getMemoryUsage();
+}
+
+void CandleArchive::limitCache(void* user, size_t limitBytes)
+{
+    ((CandleArchive*)user)->setCacheLimit(limitBytes);
+}
+
+int CandleArchive::cacheBlocksFor(size_t limitBytes) const
+{
+    size_t blockBytes = (size_t)m_header.blockSize * sizeof(Candle);
+    if (blockBytes == 0 || limitBytes / blockBytes >= (size_t)CACHE_BLOCKS)
+        return CACHE_BLOCKS;
+    int blocks = (int)(limitBytes / blockBytes);
+    return blocks > MIN_CACHE_BLOCKS ? blocks : MIN_CACHE_BLOCKS;
+}
+
+void CandleArchive::resizeCache()
+{
+    // Reads complete into their slot, so slots only move with none in flight
+    int blocks = cacheBlocksFor(m_cacheLimit);
+    if (m_state != STATE_READY || blocks == m_cacheBlocks || m_loadsInFlight > 0)
+        return;
+    
+    // Most recently used blocks first into the new cache
+    size_t blockSize = m_header.blockSize;
+    std::vector<Candle> cache((size_t)blocks * blockSize);
+    Slot kept[CACHE_BLOCKS];
+    int keptCount = 0;
+    while (keptCount < blocks)
+    {
+        int newest = -1;
+        for (int i = 0; i < m_cacheBlocks; i++)
+        {
+            if (m_slots[i].block >= 0 && (newest < 0 || m_slots[i].lastUsed > m_slots[newest].lastUsed))
+                newest = i;
+        }
+        if (newest < 0)
+            break;
+        
+        memcpy(&cache[keptCount * blockSize], &m_cache[newest * blockSize], blockSize * sizeof(Candle));
+        kept[keptCount++] = m_slots[newest];
+        m_slots[newest].block = -1;
+    }
+    
+    for (int i = 0; i < CACHE_BLOCKS; i++)
+    {
+        if (i < keptCount)
+        {
+            m_slots[i] = kept[i];
+        }
+        else
+        {
+            m_slots[i].block = -1;
+            m_slots[i].lastUsed = 0;
+        }
+    }
+    m_cache.swap(cache);
+    m_cacheBlocks = blocks;
+    updateResident();
+}
+
+const Candle* CandleArchive::getBlock(int block)
+{
+    if (m_state != STATE_READY || block < 0 || block >= getBlockCount())
+        return nullptr;
+    
+    int slot = findSlot(block);
+    if (slot < 0)
+    {
+        m_blockMisses->add();
+        slot = startLoad(block);
+    }
+    if (slot < 0 || m_slots[slot].loading || m_slots[slot].block != block)
+        return nullptr;
+    
+    m_slots[slot].lastUsed = m_frame;
+    return &m_cache[(size_t)slot * m_header.blockSize];
+}
+
+void CandleArchive::prefetch(int block)
+{
+    if (m_state != STATE_READY || block < 0 || block >= getBlockCount() || findSlot(block) >= 0)
+        return;
+    
+    const ArchiveBlock& entry = m_blocks[block];
+    platformFilePrefetch(m_file, entry.offset, entry.bytes);
+    startLoad(block);
+}
+
+int64_t CandleArchive::countBefore(TimeNs t)
+{
+    if (m_state != STATE_READY)
+        return 0;
+    
+    // Last block opening before t
+    int lo = 0;
+    int hi = getBlockCount();
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (m_blocks[mid].firstTime < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return 0;
+    
+    int block = lo - 1;
+    int64_t start = (int64_t)block * m_header.blockSize;
+    const ArchiveBlock& entry = m_blocks[block];
+    if (entry.lastTime < t)
+        return start + entry.count;
+    
+    // t falls inside the block: exact once it is resident
+    const Candle* candles = getBlock(block);
+    if (!candles)
+        return start;
+    
+    lo = 0;
+    hi = (int)entry.count;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (candles[mid].time < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return start + lo;
+}
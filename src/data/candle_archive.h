@@ -0,0 +1,150 @@
+#pragma once
+
+#include "../chart/candle.h"
+#include "../perf/metrics.h"
+#include "../perf/memory_budget.h"
+#include "../platform/platform.h"
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// CANDLE ARCHIVE
+// On-disk history older than the in-memory candle buffer, stored columnar
+// with a time-block index:
+//
+//   ArchiveHeader                 magic, version, counts, interval, tick size
+//   ArchiveBlock[blockCount]      time range, file offset and size per block
+//   block data                    time[n] int64, open/high/low/close[n] int32
+//
+// Natively the file is memory-mapped; in WASM blocks arrive through HTTP
+// Range requests (serve.js). Blocks are decoded into an LRU cache of at
+// most CACHE_BLOCKS slots, so memory stays bounded however long the archive
+// is; a memory budget can cap it further. Used from the render thread only.
+// ============================================================================
+
+static const uint32_t ARCHIVE_MAGIC = 0x3141434D;   // "MCA1"
+static const uint32_t ARCHIVE_VERSION = 1;
+
+struct ArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSize;     // Candles per block (the last block may hold fewer)
+    uint32_t blockCount;
+    int64_t candleCount;
+    TimeNs intervalNs;
+    double tickSize;
+    uint64_t indexOffset;   // ArchiveBlock[blockCount] starts here
+};
+
+struct ArchiveBlock
+{
+    TimeNs firstTime;
+    TimeNs lastTime;
+    uint64_t offset;        // Block data (columns) starts here
+    uint32_t count;
+    uint32_t bytes;
+};
+
+static_assert(sizeof(ArchiveHeader) == 48 && sizeof(ArchiveBlock) == 32, "Archive layout is fixed on disk");
+
+// Write time-ordered candles as an archive (native file, or MEMFS in WASM)
+bool writeCandleArchive(const char* path, const Candle* candles, int64_t count,
+                        TimeNs intervalNs, double tickSize, int blockSize = 4096);
+
+class CandleArchive
+{
+public:
+    static const int CACHE_BLOCKS = 16;         // Resident blocks (LRU)
+    static const int MIN_CACHE_BLOCKS = 2;      // Floor under a memory cap (a visible window spans two)
+    static const int MAX_LOADS_IN_FLIGHT = 4;
+    
+    CandleArchive();
+    ~CandleArchive();
+    
+    // Start reading the header and index (completes later in WASM)
+    bool open(const char* path);
+    void close();   // Only once no reads are in flight (!isLoading())
+    bool isReady() const { return m_state == STATE_READY; }
+    bool isLoading() const { return m_state == STATE_OPENING || m_loadsInFlight > 0; }
+    
+    TimeNs getIntervalNs() const { return m_header.intervalNs; }
+    double getTickSize() const { return m_header.tickSize; }
+    int64_t getCandleCount() const { return m_header.candleCount; }
+    int getBlockSize() const { return (int)m_header.blockSize; }
+    int getBlockCount() const { return (int)m_blocks.size(); }
+    
+    // Call once per frame: blocks used in the current frame are never
+    // evicted. Applies a pending cache cap.
+    void beginFrame();
+    
+    // Cap the block cache (MemoryBudget::UNLIMITED: CACHE_BLOCKS). Applied
+    // on the next beginFrame() with no reads in flight; the most recently
+    // used blocks stay resident.
+    void setCacheLimit(size_t limitBytes) { m_cacheLimit = limitBytes; }
+    size_t getMemoryUsage() const;  // Block cache bytes
+    
+    // Add the block cache to a budget as the first store to shrink
+    void registerMemory(MemoryBudget& budget);
+    
+    // Number of archived candles opening before t. Exact when the block
+    // holding t is resident, otherwise rounded down to that block's start
+    // (and the block is requested).
+    int64_t countBefore(TimeNs t);
+    
+    // Decoded candles of a block, or nullptr while it is not resident (a
+    // load is started). Valid until the next frame's loads may evict it.
+    const Candle* getBlock(int block);
+    
+    // Start loading a block ahead of use without marking it as used
+    void prefetch(int block);
+    
+private:
+    enum State
+    {
+        STATE_CLOSED,
+        STATE_OPENING,
+        STATE_READY,
+        STATE_FAILED
+    };
+    
+    struct Slot
+    {
+        CandleArchive* owner;
+        int block;          // -1 = empty
+        uint64_t lastUsed;  // Frame stamp for LRU
+        bool loading;
+    };
+    
+    State m_state;
+    PlatformFile* m_file;
+    ArchiveHeader m_header;
+    std::vector<ArchiveBlock> m_blocks;
+    
+    // Decoded block cache: m_cacheBlocks slots of blockSize candles
+    std::vector<Candle> m_cache;
+    Slot m_slots[CACHE_BLOCKS];
+    int m_cacheBlocks;
+    size_t m_cacheLimit;
+    uint64_t m_frame;
+    int m_loadsInFlight;
+    
+    // Metrics (owned by MetricsRegistry)
+    Metric* m_blocksLoaded;
+    Metric* m_blockMisses;
+    Metric* m_loadErrors;
+    Metric* m_bytesRead;
+    Metric* m_residentBlocks;
+    
+    int findSlot(int block) const;
+    int startLoad(int block);
+    void updateResident();
+    int cacheBlocksFor(size_t limitBytes) const;
+    void resizeCache();
+    
+    static void onHeaderRead(void* user, const void* data, size_t size);
+    static void onIndexRead(void* user, const void* data, size_t size);
+    static void onBlockRead(void* user, const void* data, size_t size);
+    static size_t cacheUsage(void* user);
+    static void limitCache(void* user, size_t limitBytes);
+};
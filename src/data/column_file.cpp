@@ -0,0 +1,290 @@
+#include "column_file.h"
+#include <stdio.h>
+#include <string.h>
+
+// Column data alignment (cache line; enough for any reader's dtype)
+static const size_t COLUMN_ALIGN = 64;
+
+// Upper bound on directory size accepted from a file (sanity check)
+static const uint32_t MAX_COLUMNS = 64;
+
+static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+// One column being written: values widened to int64 for a uniform encoder
+struct ColumnData
+{
+    const char* name;
+    ColumnType type;
+    std::vector<int64_t> values;
+};
+
+static void appendColumn(std::vector<unsigned char>& file, std::vector<ColumnEntry>& entries,
+                         const ColumnData& column, bool compress)
+{
+    ColumnEntry entry = {};
+    snprintf(entry.name, sizeof(entry.name), "%s", column.name);
+    entry.type = column.type;
+    entry.encoding = compress ? COLUMN_DELTA_VARINT : COLUMN_RAW;
+    entry.count = column.values.size();
+    
+    file.resize((file.size() + COLUMN_ALIGN - 1) & ~(COLUMN_ALIGN - 1), 0);
+    entry.offset = file.size();
+    
+    size_t n = column.values.size();
+    if (!compress && column.type == COLUMN_INT64)
+    {
+        file.resize(entry.offset + n * sizeof(int64_t));
+        memcpy(file.data() + entry.offset, column.values.data(), n * sizeof(int64_t));
+    }
+    else if (!compress)
+    {
+        file.resize(entry.offset + n * sizeof(int32_t));
+        int32_t* out = (int32_t*)(file.data() + entry.offset);
+        for (size_t i = 0; i < n; i++)
+            out[i] = (int32_t)column.values[i];
+    }
+    else
+    {
+        // Deltas wrap in unsigned math, so any int64 sequence round-trips
+        uint64_t previous = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t v = zigzag((int64_t)((uint64_t)column.values[i] - previous));
+            previous = (uint64_t)column.values[i];
+            while (v >= 0x80)
+            {
+                file.push_back((unsigned char)(v | 0x80));
+                v >>= 7;
+            }
+            file.push_back((unsigned char)v);
+        }
+    }
+    
+    entry.bytes = file.size() - entry.offset;
+    entries.push_back(entry);
+}
+
+int64_t writeColumnFile(const char* path, const CandleBuffer& candles, const TickHistory& ticks,
+                     TimeNs intervalNs, double tickSize, bool compress)
+{
+    // Transpose the ring buffers (array of structs) into columns
+    ColumnData columns[7] =
+    {
+        { "candle.time", COLUMN_INT64, {} },
+        { "candle.open", COLUMN_INT32, {} },
+        { "candle.high", COLUMN_INT32, {} },
+        { "candle.low", COLUMN_INT32, {} },
+        { "candle.close", COLUMN_INT32, {} },
+        { "tick.time", COLUMN_INT64, {} },
+        { "tick.price", COLUMN_INT32, {} }
+    };
+    for (int c = 0; c < 5; c++)
+        columns[c].values.reserve(candles.count());
+    for (int c = 5; c < 7; c++)
+        columns[c].values.reserve(ticks.count());
+    
+    RangeView<Candle> candleView = candles.segments();
+    for (int s = 0; s < 2; s++)
+    {
+        for (int i = 0; i < candleView.spans[s].count; i++)
+        {
+            const Candle& candle = candleView.spans[s].data[i];
+            columns[0].values.push_back(candle.time);
+            columns[1].values.push_back(candle.open);
+            columns[2].values.push_back(candle.high);
+            columns[3].values.push_back(candle.low);
+            columns[4].values.push_back(candle.close);
+        }
+    }
+    RangeView<Tick> tickView = ticks.segments();
+    for (int s = 0; s < 2; s++)
+    {
+        for (int i = 0; i < tickView.spans[s].count; i++)
+        {
+            columns[5].values.push_back(tickView.spans[s].data[i].timestamp);
+            columns[6].values.push_back(tickView.spans[s].data[i].price);
+        }
+    }
+    
+    ColumnFileHeader header = {};
+    header.magic = COLUMN_FILE_MAGIC;
+    header.version = COLUMN_FILE_VERSION;
+    header.columnCount = 7;
+    header.tickSize = tickSize;
+    header.intervalNs = intervalNs;
+    header.candleCount = candles.count();
+    header.tickCount = ticks.count();
+    
+    // Whole file in memory (the buffers are a few MB at most), one write
+    std::vector<unsigned char> file(sizeof(header) + sizeof(ColumnEntry) * header.columnCount);
+    std::vector<ColumnEntry> entries;
+    for (int c = 0; c < 7; c++)
+        appendColumn(file, entries, columns[c], compress);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), entries.data(), sizeof(ColumnEntry) * entries.size());
+    
+    FILE* out = fopen(path, "wb");
+    if (!out)
+        return -1;
+    bool ok = fwrite(file.data(), 1, file.size(), out) == file.size();
+    if (fclose(out) != 0)
+        ok = false;
+    return ok ? (int64_t)file.size() : -1;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+static bool decodeColumn(const std::vector<unsigned char>& file, const ColumnEntry& entry, std::vector<int64_t>& out)
+{
+    // Every encoding takes at least a byte per value (bounds count by file size)
+    if (entry.count > entry.bytes)
+        return false;
+    const unsigned char* data = file.data() + entry.offset;
+    out.resize(entry.count);
+    
+    if (entry.encoding == COLUMN_RAW)
+    {
+        size_t width = entry.type == COLUMN_INT64 ? sizeof(int64_t) : sizeof(int32_t);
+        if (entry.bytes != entry.count * width)
+            return false;
+        if (entry.type == COLUMN_INT64)
+        {
+            memcpy(out.data(), data, entry.bytes);
+            return true;
+        }
+        for (uint64_t i = 0; i < entry.count; i++)
+        {
+            int32_t v;
+            memcpy(&v, data + i * sizeof(int32_t), sizeof(v));
+            out[i] = v;
+        }
+        return true;
+    }
+    
+    if (entry.encoding != COLUMN_DELTA_VARINT)
+        return false;
+    
+    const unsigned char* p = data;
+    const unsigned char* end = data + entry.bytes;
+    uint64_t previous = 0;
+    for (uint64_t i = 0; i < entry.count; i++)
+    {
+        uint64_t v = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+            if (p == end || shift > 63)
+                return false;
+            v |= (uint64_t)(*p & 0x7F) << shift;
+            if ((*p++ & 0x80) == 0)
+                break;
+        }
+        previous += (uint64_t)unzigzag(v);
+        out[i] = (int64_t)previous;
+    }
+    return p == end;
+}
+
+// Decoded column by name; absent columns are empty
+static bool findColumn(const std::vector<unsigned char>& file, const ColumnEntry* entries, uint32_t count,
+                       const char* name, uint64_t expected, std::vector<int64_t>& out)
+{
+    out.clear();
+    for (uint32_t c = 0; c < count; c++)
+    {
+        if (strncmp(entries[c].name, name, sizeof(entries[c].name)) == 0)
+            return entries[c].count == expected && decodeColumn(file, entries[c], out);
+    }
+    return expected == 0;
+}
+
+bool readColumnFile(const char* path, std::vector<Candle>& candles, std::vector<Tick>& ticks,
+                    TimeNs& intervalNs, double& tickSize)
+{
+    FILE* in = fopen(path, "rb");
+    if (!in)
+        return false;
+    
+    std::vector<unsigned char> file;
+    if (fseek(in, 0, SEEK_END) == 0)
+    {
+        long size = ftell(in);
+        if (size > 0)
+        {
+            file.resize((size_t)size);
+            rewind(in);
+            if (fread(file.data(), 1, file.size(), in) != file.size())
+                file.clear();
+        }
+    }
+    fclose(in);
+    
+    ColumnFileHeader header;
+    if (file.size() < sizeof(header))
+        return false;
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != COLUMN_FILE_MAGIC || header.version != COLUMN_FILE_VERSION ||
+        header.columnCount > MAX_COLUMNS || header.candleCount < 0 || header.tickCount < 0 ||
+        file.size() < sizeof(header) + sizeof(ColumnEntry) * header.columnCount)
+        return false;
+    
+    std::vector<ColumnEntry> entries(header.columnCount);
+    memcpy(entries.data(), file.data() + sizeof(header), sizeof(ColumnEntry) * entries.size());
+    for (const ColumnEntry& entry : entries)
+    {
+        if (entry.offset > file.size() || entry.bytes > file.size() - entry.offset)
+            return false;
+    }
+    
+    // Unknown columns are ignored (readers of this version skip additions)
+    std::vector<int64_t> time, open, high, low, close;
+    const ColumnEntry* directory = entries.data();
+    uint64_t candleCount = (uint64_t)header.candleCount;
+    uint64_t tickCount = (uint64_t)header.tickCount;
+    if (!findColumn(file, directory, header.columnCount, "candle.time", candleCount, time) ||
+        !findColumn(file, directory, header.columnCount, "candle.open", candleCount, open) ||
+        !findColumn(file, directory, header.columnCount, "candle.high", candleCount, high) ||
+        !findColumn(file, directory, header.columnCount, "candle.low", candleCount, low) ||
+        !findColumn(file, directory, header.columnCount, "candle.close", candleCount, close))
+        return false;
+    
+    candles.resize(candleCount);
+    for (uint64_t i = 0; i < candleCount; i++)
+        candles[i] = Candle(time[i], (PriceTicks)open[i], (PriceTicks)high[i], (PriceTicks)low[i], (PriceTicks)close[i]);
+    
+    if (!findColumn(file, directory, header.columnCount, "tick.time", tickCount, time) ||
+        !findColumn(file, directory, header.columnCount, "tick.price", tickCount, open))
+        return false;
+    
+    ticks.resize(tickCount);
+    for (uint64_t i = 0; i < tickCount; i++)
+        ticks[i] = Tick((PriceTicks)open[i], time[i]);
+    
+    intervalNs = header.intervalNs;
+    tickSize = header.tickSize;
+    return true;
+}
+
+BackfillBatch* readColumnBatch(const char* path, TimeNs end, TimeNs candleIntervalNs, double tickSize)
+{
+    BackfillBatch* batch = new BackfillBatch();
+    TimeNs intervalNs;
+    double fileTickSize;
+    if (!readColumnFile(path, batch->candles, batch->ticks, intervalNs, fileTickSize) || fileTickSize != tickSize)
+    {
+        delete batch;
+        return nullptr;
+    }
+    
+    if (intervalNs != candleIntervalNs)
+        batch->candles.clear();
+    if (batch->candles.empty() && batch->ticks.empty())
+    {
+        delete batch;
+        return nullptr;
+    }
+    batch->shiftToEnd(end, candleIntervalNs);
+    return batch;
+}
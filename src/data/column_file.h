@@ -0,0 +1,79 @@
+#pragma once
+
+#include "data_pipeline.h"
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// COLUMN FILE
+// Candles and ticks exported one column per field, for offline analysis and
+// for seeding other instances (loaded back through the backfill path):
+//
+//   ColumnFileHeader              magic, version, counts, interval, tick size
+//   ColumnEntry[columnCount]      name, type, encoding, offset, size per column
+//   column data                   each column starts 64-byte aligned
+//
+// Columns: candle.time, candle.open, candle.high, candle.low, candle.close,
+// tick.time (int64 ns on the exporting instance's data clock) and
+// tick.price (int32 price ticks). Raw columns are plain little-endian arrays,
+// so NumPy/Arrow-style readers can map them zero-copy at their offset.
+// Encoded columns store zigzag LEB128 varints of the deltas between values
+// (times are near-constant steps, prices small moves).
+// ============================================================================
+
+static const uint32_t COLUMN_FILE_MAGIC = 0x3143434D;  // "MCC1"
+static const uint32_t COLUMN_FILE_VERSION = 1;
+
+enum ColumnType
+{
+    COLUMN_INT64 = 0,
+    COLUMN_INT32 = 1
+};
+
+enum ColumnEncoding
+{
+    COLUMN_RAW = 0,             // count values, memcpy-able
+    COLUMN_DELTA_VARINT = 1     // count zigzag varint deltas (first from 0)
+};
+
+struct ColumnFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t columnCount;
+    uint32_t reserved;
+    double tickSize;
+    TimeNs intervalNs;          // Candle interval
+    int64_t candleCount;
+    int64_t tickCount;
+    uint64_t reserved2[2];
+};
+
+struct ColumnEntry
+{
+    char name[16];              // NUL-terminated, e.g. "candle.time"
+    uint32_t type;              // ColumnType
+    uint32_t encoding;          // ColumnEncoding
+    uint64_t count;
+    uint64_t offset;            // From the start of the file
+    uint64_t bytes;
+};
+
+static_assert(sizeof(ColumnFileHeader) == 64 && sizeof(ColumnEntry) == 48, "Column file layout is fixed on disk");
+
+// Write every candle and tick of the buffers (oldest first). Returns the
+// file size in bytes, or -1 when the file could not be written.
+int64_t writeColumnFile(const char* path, const CandleBuffer& candles, const TickHistory& ticks,
+                     TimeNs intervalNs, double tickSize, bool compress);
+
+// Read a column file back into time-ordered candles and ticks (times as
+// exported). Returns false for missing, malformed or truncated files.
+bool readColumnFile(const char* path, std::vector<Candle>& candles, std::vector<Tick>& ticks,
+                    TimeNs& intervalNs, double& tickSize);
+
+// Read a column file as a heap batch for DataPipeline::backfill, shifted so
+// the newest data ends at `end` (see BackfillBatch::shiftToEnd). Candles are
+// included only when exported at candleIntervalNs. Returns nullptr when the
+// file cannot be read, holds no usable rows or was written with another
+// tick size.
+BackfillBatch* readColumnBatch(const char* path, TimeNs end, TimeNs candleIntervalNs, double tickSize);
@@ -0,0 +1,433 @@
+#include "csv_import.h"
+#include "../kernels/csv_scan.h"
+#include <string.h>
+#include <math.h>
+#include <charconv>
+
+// Fraction digits beyond this are ignored (keeps integer math in range)
+static const int MAX_FRACTION_DIGITS = 9;
+
+static const int64_t POW10[MAX_FRACTION_DIGITS + 1] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// "[-]digits[.digits]" split into whole and fraction / scale
+struct Decimal
+{
+    uint64_t whole;
+    int64_t fraction;
+    int64_t scale;      // 10^fraction digits
+    bool negative;
+};
+
+static bool parseDecimal(const char* first, const char* last, Decimal& out)
+{
+    out.negative = first < last && *first == '-';
+    if (out.negative)
+        first++;
+    
+    std::from_chars_result result = std::from_chars(first, last, out.whole);
+    if (result.ec != std::errc())
+        return false;
+    first = result.ptr;
+    
+    out.fraction = 0;
+    out.scale = 1;
+    if (first < last && *first == '.')
+    {
+        first++;
+        const char* end = last - first > MAX_FRACTION_DIGITS ? first + MAX_FRACTION_DIGITS : last;
+        if (first < end && (unsigned)(*first - '0') < 10)
+        {
+            result = std::from_chars(first, end, out.fraction);
+            out.scale = POW10[result.ptr - first];
+            first = result.ptr;
+        }
+        while (first < last && *first >= '0' && *first <= '9')
+            first++;
+    }
+    return first == last;
+}
+
+CsvImporter::CsvImporter()
+    : m_ticksPerUnit(0)
+    , m_maxWholeTime(0)
+    , m_lastTickTime(0)
+    , m_lastCandleTime(0)
+    , m_candleIntervalNs(0)
+    , m_carryLength(0)
+    , m_skipping(false)
+    , m_headerChecked(false)
+    , m_separators(SCAN_BLOCK)
+    , m_file(nullptr)
+    , m_offset(0)
+    , m_reading(false)
+    , m_done(false)
+    , m_failed(false)
+    , m_startMs(0.0)
+    , m_elapsedMs(0.0)
+    , m_bytes(0)
+    , m_tickRows(0)
+    , m_candleRows(0)
+    , m_errors(0)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_bytesParsed = metrics.counter("import.bytes");
+    m_rowsParsed = metrics.rate("import.rows");
+    m_rowErrors = metrics.counter("import.errors");
+    m_throughput = metrics.gauge("import.gb_per_s");
+}
+
+CsvImporter::~CsvImporter()
+{
+    close();
+}
+
+void CsvImporter::begin(const Config& config)
+{
+    m_config = config;
+    
+    // Exact decimal -> tick conversion when the tick size is 1/integer
+    double perUnit = 1.0 / config.tickSize;
+    m_ticksPerUnit = fabs(perUnit - llround(perUnit)) < 1e-6 && perUnit <= 1e9 ? llround(perUnit) : 0;
+    m_maxWholeTime = (uint64_t)(INT64_MAX / config.timeUnitNs);
+    
+    m_ticks.reset(config.maxTicks);
+    m_candles.reset(config.maxCandles);
+    m_lastTickTime = INT64_MIN;
+    m_lastCandleTime = INT64_MIN;
+    m_candleIntervalNs = 0;
+    m_carryLength = 0;
+    m_skipping = false;
+    m_headerChecked = false;
+    m_done = false;
+    m_failed = false;
+    m_elapsedMs = 0.0;
+    m_bytes = 0;
+    m_tickRows = 0;
+    m_candleRows = 0;
+    m_errors = 0;
+}
+
+void CsvImporter::feed(const char* data, size_t size)
+{
+    m_bytes += size;
+    m_bytesParsed->add((int64_t)size);
+    
+    while (size > 0)
+    {
+        // Rest of an overlong row
+        if (m_skipping)
+        {
+            const char* newline = (const char*)memchr(data, '\n', size);
+            if (!newline)
+                return;
+            size -= newline + 1 - data;
+            data = newline + 1;
+            m_skipping = false;
+            continue;
+        }
+        
+        // Complete the row carried over from the previous piece
+        if (m_carryLength > 0)
+        {
+            const char* newline = (const char*)memchr(data, '\n', size);
+            size_t take = newline ? (size_t)(newline + 1 - data) : size;
+            
+            // MAX_LINE bytes without a newline cannot end within MAX_LINE
+            size_t length = m_carryLength + take;
+            if (length > (size_t)MAX_LINE || (!newline && length == (size_t)MAX_LINE))
+            {
+                rejectRow();
+                m_carryLength = 0;
+                m_skipping = true;
+                continue;
+            }
+            memcpy(m_carry + m_carryLength, data, take);
+            m_carryLength += (int)take;
+            data += take;
+            size -= take;
+            if (newline)
+            {
+                parseRows(m_carry, m_carryLength);
+                m_carryLength = 0;
+            }
+            continue;
+        }
+        
+        // Whole rows of the next block; a row crossing its end starts the next one
+        int n = size < (size_t)SCAN_BLOCK ? (int)size : SCAN_BLOCK;
+        int consumed = parseRows(data, n);
+        if (consumed == 0)
+        {
+            // No row end: the start of a row finished by a later piece
+            if ((size_t)n == size && n < MAX_LINE)
+            {
+                memcpy(m_carry, data, n);
+                m_carryLength = n;
+                return;
+            }
+            rejectRow();
+            m_skipping = true;
+            consumed = n;
+        }
+        data += consumed;
+        size -= consumed;
+    }
+}
+
+void CsvImporter::finish()
+{
+    // Last row without a trailing newline
+    if (m_carryLength > 0 && !m_skipping)
+    {
+        m_carry[m_carryLength++] = '\n';
+        parseRows(m_carry, m_carryLength);
+    }
+    m_carryLength = 0;
+    m_skipping = false;
+}
+
+// Parses every complete row in data[0, size); returns the bytes they span
+int CsvImporter::parseRows(const char* data, int size)
+{
+    int count = scanSeparators(data, size, m_config.delimiter, m_separators.data());
+    
+    const char* starts[MAX_FIELDS];
+    const char* ends[MAX_FIELDS];
+    int64_t rowsBefore = m_tickRows + m_candleRows;
+    int fieldCount = 0;
+    int fieldStart = 0;
+    int consumed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int end = (int)m_separators[i];
+        if (fieldCount < MAX_FIELDS)
+        {
+            starts[fieldCount] = data + fieldStart;
+            ends[fieldCount] = data + end;
+        }
+        fieldCount++;
+        fieldStart = end + 1;
+        
+        if (data[end] == '\n')
+        {
+            if (fieldStart - consumed <= MAX_LINE)
+                parseRow(starts, ends, fieldCount);
+            else
+                rejectRow();
+            fieldCount = 0;
+            consumed = fieldStart;
+        }
+    }
+    
+    m_rowsParsed->add(m_tickRows + m_candleRows - rowsBefore);
+    return consumed;
+}
+
+void CsvImporter::parseRow(const char* const* starts, const char** ends, int fieldCount)
+{
+    if (fieldCount <= MAX_FIELDS)
+    {
+        // CRLF line endings
+        const char*& last = ends[fieldCount - 1];
+        if (last > starts[fieldCount - 1] && last[-1] == '\r')
+            last--;
+        
+        // Blank line
+        if (fieldCount == 1 && last == starts[0])
+            return;
+    }
+    
+    TimeNs time;
+    bool isTick = fieldCount == 2 || fieldCount == 3;
+    bool isCandle = fieldCount == 5 || fieldCount == 6;
+    bool valid = (isTick || isCandle) && parseTime(starts[0], ends[0], time);
+    
+    // A non-numeric first row is the header
+    bool first = !m_headerChecked;
+    m_headerChecked = true;
+    if (!valid && first)
+        return;
+    
+    if (valid && isTick)
+    {
+        PriceTicks price;
+        valid = parsePrice(starts[1], ends[1], price) && time >= m_lastTickTime;
+        if (valid)
+        {
+            m_ticks.push(Tick(price, time));
+            m_lastTickTime = time;
+            m_tickRows++;
+        }
+    }
+    else if (valid)
+    {
+        PriceTicks open, high, low, close;
+        valid = parsePrice(starts[1], ends[1], open) && parsePrice(starts[2], ends[2], high) &&
+                parsePrice(starts[3], ends[3], low) && parsePrice(starts[4], ends[4], close) &&
+                time > m_lastCandleTime;
+        if (valid)
+        {
+            if (m_candleRows > 0 && (m_candleIntervalNs == 0 || time - m_lastCandleTime < m_candleIntervalNs))
+                m_candleIntervalNs = time - m_lastCandleTime;
+            m_candles.push(Candle(time, open, high, low, close));
+            m_lastCandleTime = time;
+            m_candleRows++;
+        }
+    }
+    
+    if (!valid)
+        rejectRow();
+}
+
+void CsvImporter::rejectRow()
+{
+    m_errors++;
+    m_rowErrors->add();
+}
+
+bool CsvImporter::parseTime(const char* first, const char* last, TimeNs& out) const
+{
+    Decimal value;
+    if (!parseDecimal(first, last, value) || value.whole > m_maxWholeTime)
+        return false;
+    
+    TimeNs ns = (TimeNs)value.whole * m_config.timeUnitNs;
+    if (value.fraction > 0)
+        ns += (TimeNs)((double)value.fraction * m_config.timeUnitNs / value.scale + 0.5);
+    out = value.negative ? -ns : ns;
+    return true;
+}
+
+bool CsvImporter::parsePrice(const char* first, const char* last, PriceTicks& out) const
+{
+    Decimal value;
+    if (!parseDecimal(first, last, value) || value.whole > (uint64_t)INT32_MAX)
+        return false;
+    
+    int64_t ticks;
+    if (m_ticksPerUnit > 0)
+    {
+        // Whole units exactly, the fraction rounded half up to the tick grid
+        // (no division when it has as many digits as the grid, e.g. cents)
+        ticks = (int64_t)value.whole * m_ticksPerUnit;
+        if (value.scale == m_ticksPerUnit)
+            ticks += value.fraction;
+        else
+            ticks += (value.fraction * m_ticksPerUnit * 2 + value.scale) / (value.scale * 2);
+    }
+    else
+    {
+        ticks = llround(((double)value.whole + (double)value.fraction / value.scale) / m_config.tickSize);
+    }
+    if (ticks > INT32_MAX)
+        return false;
+    
+    out = (PriceTicks)(value.negative ? -ticks : ticks);
+    return true;
+}
+
+// ============================================================================
+// FILE STREAMING
+// ============================================================================
+
+bool CsvImporter::open(const char* path, const Config& config)
+{
+    close();
+    begin(config);
+    
+    m_file = platformFileOpen(path);
+    if (!m_file)
+    {
+        m_done = true;
+        m_failed = true;
+        return false;
+    }
+    m_offset = 0;
+    m_startMs = platformNowMs();
+    return true;
+}
+
+bool CsvImporter::pump(double budgetMs)
+{
+    double start = platformNowMs();
+    while (m_file && !m_reading && platformNowMs() - start < budgetMs)
+    {
+        // Native: completes (and parses) inside the call; WASM: later
+        m_reading = true;
+        platformFilePrefetch(m_file, m_offset + CHUNK_BYTES, CHUNK_BYTES);
+        platformFileReadSome(m_file, m_offset, CHUNK_BYTES, onChunkRead, this);
+    }
+    return !m_done;
+}
+
+void CsvImporter::close()
+{
+    // WASM: an in-flight read still references the file
+    if (m_reading)
+        return;
+    
+    platformFileClose(m_file);
+    m_file = nullptr;
+}
+
+void CsvImporter::onChunkRead(void* user, const void* data, size_t size)
+{
+    CsvImporter* importer = (CsvImporter*)user;
+    importer->m_reading = false;
+    if (!data)
+    {
+        importer->complete(true);
+        return;
+    }
+    
+    importer->feed((const char*)data, size);
+    importer->m_offset += size;
+    if (size < (size_t)CHUNK_BYTES)
+        importer->complete(false);
+}
+
+void CsvImporter::complete(bool failed)
+{
+    finish();
+    close();
+    m_done = true;
+    m_failed = failed;
+    m_elapsedMs = platformNowMs() - m_startMs;
+    if (m_elapsedMs > 0.0)
+        m_throughput->set(m_bytes / m_elapsedMs / 1e6);
+}
+
+BackfillBatch* CsvImporter::takeBatch(TimeNs end, TimeNs candleIntervalNs)
+{
+    bool useCandles = m_candles.count() > 0 && (m_candles.count() == 1 || m_candleIntervalNs == candleIntervalNs);
+    if (!useCandles && m_ticks.count() == 0)
+    {
+        m_candles.clear();
+        return nullptr;
+    }
+    
+    BackfillBatch* batch = new BackfillBatch();
+    if (useCandles)
+    {
+        batch->candles.resize(m_candles.count());
+        RangeView<Candle> view = m_candles.segments();
+        memcpy(batch->candles.data(), view.spans[0].data, sizeof(Candle) * view.spans[0].count);
+        memcpy(batch->candles.data() + view.spans[0].count, view.spans[1].data, sizeof(Candle) * view.spans[1].count);
+    }
+    
+    if (m_ticks.count() > 0)
+    {
+        batch->ticks.resize(m_ticks.count());
+        RangeView<Tick> view = m_ticks.segments();
+        memcpy(batch->ticks.data(), view.spans[0].data, sizeof(Tick) * view.spans[0].count);
+        memcpy(batch->ticks.data() + view.spans[0].count, view.spans[1].data, sizeof(Tick) * view.spans[1].count);
+    }
+    batch->shiftToEnd(end, candleIntervalNs);
+    
+    m_ticks.clear();
+    m_candles.clear();
+    return batch;
+}
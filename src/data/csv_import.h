@@ -0,0 +1,133 @@
+#pragma once
+
+#include "data_pipeline.h"
+#include "ring_buffer.h"
+#include "../perf/metrics.h"
+#include "../platform/platform.h"
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// CSV IMPORTER
+// Loads historical ticks and candles from CSV text. One row per line, kind
+// chosen by its field count:
+//
+//   timestamp,price[,volume]                   tick
+//   timestamp,open,high,low,close[,volume]     candle
+//
+// Timestamps are integer or decimal multiples of Config::timeUnitNs; prices
+// are decimals converted to integer price ticks without going through
+// floating point (when 1 / tick size is an integer). A non-numeric first row
+// is taken as a header. Volume is accepted but not stored. Rows must be in
+// time order; out-of-order rows are counted as errors and skipped.
+//
+// Text is fed in pieces of any size: each block is scanned for separators
+// with the csv_scan kernel and fields are parsed with std::from_chars
+// straight into fixed-capacity ring buffers, so there is no per-row
+// allocation and only the newest rows that fit are kept. Files stream in
+// CHUNK_BYTES reads through the platform file layer (memory-mapped natively,
+// HTTP Range requests in WASM), so multi-GB files never sit in memory.
+// ============================================================================
+
+class CsvImporter
+{
+public:
+    static const int CHUNK_BYTES = 2 << 20;     // File read size
+    static const int SCAN_BLOCK = 64 << 10;     // Text scanned per kernel call
+    static const int MAX_LINE = 256;            // Longer rows are rejected
+    static const int MAX_FIELDS = 6;
+    
+    struct Config
+    {
+        TimeNs timeUnitNs;      // Timestamp unit (default milliseconds)
+        double tickSize;        // Price grid of the chart the rows are for
+        char delimiter;
+        int maxTicks;           // Newest rows kept per kind
+        int maxCandles;
+        
+        Config()
+            : timeUnitNs(1000000), tickSize(0.01), delimiter(',')
+            , maxTicks(TickHistory::MAX_TICKS), maxCandles(CandleBuffer::MAX_CANDLES)
+        {}
+    };
+    
+    CsvImporter();
+    ~CsvImporter();
+    
+    // Text: begin(), feed() pieces split anywhere, then finish()
+    void begin(const Config& config);
+    void feed(const char* data, size_t size);
+    void finish();
+    
+    // File (native path, or URL in WASM): open(), then pump() until it
+    // returns false. Each pump parses arriving chunks for up to budgetMs
+    // (natively reads complete inside the call).
+    bool open(const char* path, const Config& config);
+    bool pump(double budgetMs);
+    void close();
+    bool isDone() const { return m_done; }
+    bool isFailed() const { return m_failed; }
+    
+    int64_t getBytes() const { return m_bytes; }
+    int64_t getTickRows() const { return m_tickRows; }
+    int64_t getCandleRows() const { return m_candleRows; }
+    int64_t getErrors() const { return m_errors; }     // Malformed, too long or out-of-order rows
+    TimeNs getCandleIntervalNs() const { return m_candleIntervalNs; }   // Smallest step between candles
+    double getElapsedMs() const { return m_elapsedMs; }                 // open() to done
+    
+    // Kept rows as a heap batch for DataPipeline::backfill, shifted so the
+    // newest ends at `end` (the live data clock starts at 0), candles on
+    // their interval grid. Candles are included only when their interval is
+    // candleIntervalNs. Returns nullptr when nothing was parsed; clears the
+    // kept rows.
+    BackfillBatch* takeBatch(TimeNs end, TimeNs candleIntervalNs);
+    
+private:
+    Config m_config;
+    int64_t m_ticksPerUnit;     // 1 / tickSize when integral (exact price parsing), else 0
+    uint64_t m_maxWholeTime;    // Largest timestamp that fits in TimeNs
+    
+    // Newest parsed rows
+    DynamicRingBuffer<Tick> m_ticks;
+    DynamicRingBuffer<Candle> m_candles;
+    TimeNs m_lastTickTime;
+    TimeNs m_lastCandleTime;
+    TimeNs m_candleIntervalNs;
+    
+    // Row split across feed() pieces, or an overlong row being skipped
+    char m_carry[MAX_LINE];
+    int m_carryLength;
+    bool m_skipping;
+    bool m_headerChecked;
+    
+    std::vector<uint32_t> m_separators;     // Scan output, SCAN_BLOCK entries
+    
+    // File streaming
+    PlatformFile* m_file;
+    uint64_t m_offset;
+    bool m_reading;
+    bool m_done;
+    bool m_failed;
+    double m_startMs;
+    double m_elapsedMs;
+    
+    int64_t m_bytes;
+    int64_t m_tickRows;
+    int64_t m_candleRows;
+    int64_t m_errors;
+    
+    // Metrics (owned by MetricsRegistry)
+    Metric* m_bytesParsed;
+    Metric* m_rowsParsed;
+    Metric* m_rowErrors;
+    Metric* m_throughput;
+    
+    int parseRows(const char* data, int size);
+    void parseRow(const char* const* starts, const char** ends, int fieldCount);
+    bool parseTime(const char* first, const char* last, TimeNs& out) const;
+    bool parsePrice(const char* first, const char* last, PriceTicks& out) const;
+    void rejectRow();
+    void complete(bool failed);
+    
+    static void onChunkRead(void* user, const void* data, size_t size);
+};
@@ -0,0 +1,413 @@
+#include "data_pipeline.h"
+#include "column_file.h"
+#include "../platform/platform.h"
+#include <stdio.h>
+#include <string.h>
+#if DATA_PIPELINE_THREADS
+#include <chrono>
+#endif
+
+static_assert(STORE_TICKS == (int)TIER_TICKS && STORE_MINUTES == (int)TIER_MINUTES, "History stores follow HistoryTier");
+
+// Interval commands packed into one atomic word:
+// bits 0-31 interval (float bits), bit 32 preserve history, bit 33 pending
+static const uint64_t COMMAND_PRESERVE = 1ull << 32;
+static const uint64_t COMMAND_PENDING = 1ull << 33;
+
+static uint64_t encodeCommand(float interval, bool preserveHistory)
+{
+    uint32_t bits;
+    memcpy(&bits, &interval, sizeof(bits));
+    return (uint64_t)bits | (preserveHistory ? COMMAND_PRESERVE : 0) | COMMAND_PENDING;
+}
+
+// Tick policy commands use the same layout: bits 0-31 window ms (float
+// bits), bits 34-35 policy, bit 33 pending
+static const int COMMAND_POLICY_SHIFT = 34;
+
+static uint64_t encodePolicy(TickPolicy policy, float windowMs)
+{
+    return encodeCommand(windowMs, false) | ((uint64_t)policy << COMMAND_POLICY_SHIFT);
+}
+
+static float commandValue(uint64_t command)
+{
+    uint32_t bits = (uint32_t)command;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+DataPipeline::DataPipeline()
+    : m_sequence(0)
+    , m_latencyTracker(nullptr)
+    , m_command(0)
+    , m_policyCommand(0)
+    , m_backfills(nullptr)
+    , m_exports(nullptr)
+    , m_replayed(false)
+    , m_threaded(false)
+    , m_running(false)
+    , m_limitsPosted(false)
+{
+    m_ticker.setTickStampSink(this);
+    
+    for (int i = 0; i < STORE_COUNT; i++)
+    {
+        m_memoryHooks[i].pipeline = this;
+        m_memoryHooks[i].store = (PipelineStore)i;
+        m_storeLimits[i].store(MemoryBudget::UNLIMITED, std::memory_order_relaxed);
+        m_appliedLimits[i] = MemoryBudget::UNLIMITED;
+    }
+    publishMemoryUsage();
+    
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_snapshotsPublished = metrics.rate("pipeline.published");
+    m_snapshotsSkipped = metrics.counter("pipeline.skipped");
+    m_stampsDropped = metrics.counter("pipeline.stamps_dropped");
+    m_exportFiles = metrics.counter("export.files");
+    m_exportBytes = metrics.counter("export.bytes");
+    m_exportErrors = metrics.counter("export.errors");
+}
+
+DataPipeline::~DataPipeline()
+{
+    stopWorker();
+    
+    BackfillBatch* batch = m_backfills.exchange(nullptr);
+    while (batch)
+    {
+        BackfillBatch* next = batch->next;
+        delete batch;
+        batch = next;
+    }
+    
+    ExportRequest* request = m_exports.exchange(nullptr);
+    while (request)
+    {
+        ExportRequest* next = request->next;
+        delete request;
+        request = next;
+    }
+}
+
+bool DataPipeline::startWorker()
+{
+#if DATA_PIPELINE_THREADS
+    if (m_threaded)
+        return true;
+    
+    m_threaded = true;
+    m_running.store(true);
+    m_worker = std::thread(&DataPipeline::workerMain, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DataPipeline::stopWorker()
+{
+#if DATA_PIPELINE_THREADS
+    if (!m_threaded)
+        return;
+    
+    m_running.store(false);
+    m_worker.join();
+    m_threaded = false;
+#endif
+}
+
+void DataPipeline::update(float deltaTime)
+{
+    if (m_threaded)
+        return;
+    
+    step(deltaTime);
+}
+
+void DataPipeline::setCandleInterval(float interval, bool preserveHistory)
+{
+    // Latest request wins; the producer picks it up on its next step
+    m_command.store(encodeCommand(interval, preserveHistory), std::memory_order_release);
+}
+
+void DataPipeline::setTickPolicy(TickPolicy policy, double windowMs)
+{
+    m_policyCommand.store(encodePolicy(policy, (float)windowMs), std::memory_order_release);
+}
+
+void DataPipeline::backfill(BackfillBatch* batch)
+{
+    BackfillBatch* head = m_backfills.load(std::memory_order_relaxed);
+    do
+    {
+        batch->next = head;
+    } while (!m_backfills.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool DataPipeline::exportData(const char* path, bool compress)
+{
+    ExportRequest* request = new ExportRequest();
+    snprintf(request->path, sizeof(request->path), "%s", path);
+    request->compress = compress;
+    
+    if (!m_threaded)
+    {
+        bool ok = writeExport(*request);
+        delete request;
+        return ok;
+    }
+    
+    ExportRequest* head = m_exports.load(std::memory_order_relaxed);
+    do
+    {
+        request->next = head;
+    } while (!m_exports.compare_exchange_weak(head, request, std::memory_order_release, std::memory_order_relaxed));
+    return true;
+}
+
+void DataPipeline::setMemoryLimit(PipelineStore store, size_t limitBytes)
+{
+    m_storeLimits[store].store(limitBytes, std::memory_order_relaxed);
+    m_limitsPosted.store(true, std::memory_order_release);
+}
+
+void DataPipeline::registerMemory(MemoryBudget& budget)
+{
+    size_t tickFloor = MIN_STORE_RECORDS * sizeof(Tick);
+    size_t candleFloor = MIN_STORE_RECORDS * sizeof(Candle);
+    budget.add("history.ticks", MEMORY_DETAIL, tickFloor, storeUsage, limitStore, &m_memoryHooks[STORE_TICKS]);
+    budget.add("history.1s", MEMORY_DETAIL, candleFloor, storeUsage, limitStore, &m_memoryHooks[STORE_SECONDS]);
+    budget.add("candles", MEMORY_SERIES, candleFloor * (1 + SNAPSHOT_COPIES), storeUsage, limitStore, &m_memoryHooks[STORE_CANDLES]);
+    budget.add("history.1m", MEMORY_HISTORY, candleFloor, storeUsage, limitStore, &m_memoryHooks[STORE_MINUTES]);
+}
+
+size_t DataPipeline::storeUsage(void* user)
+{
+    MemoryHook* hook = (MemoryHook*)user;
+    return hook->pipeline->getMemoryUsage(hook->store);
+}
+
+void DataPipeline::limitStore(void* user, size_t limitBytes)
+{
+    MemoryHook* hook = (MemoryHook*)user;
+    hook->pipeline->setMemoryLimit(hook->store, limitBytes);
+}
+
+void DataPipeline::replayTicks(const Tick* ticks, int count)
+{
+    m_ticker.replayTicks(ticks, count);
+    m_replayed = true;
+}
+
+const ChartSnapshot& DataPipeline::acquire()
+{
+    // Ticks become visible when the render thread adopts the snapshot
+    if (m_snapshots.acquire() && m_latencyTracker)
+    {
+        const ChartSnapshot& snapshot = m_snapshots.front();
+        for (int i = 0; i < snapshot.ingestStampCount; i++)
+            m_latencyTracker->onTickVisible(snapshot.ingestStamps[i]);
+    }
+    return m_snapshots.front();
+}
+
+void DataPipeline::onTickVisible(double ingestTimeMs)
+{
+    // Stamps go straight into the snapshot being built
+    ChartSnapshot& back = m_snapshots.back();
+    if (back.ingestStampCount == ChartSnapshot::MAX_STAMPS)
+    {
+        m_stampsDropped->add();
+        return;
+    }
+    back.ingestStamps[back.ingestStampCount++] = ingestTimeMs;
+}
+
+void DataPipeline::step(float deltaTime)
+{
+    bool changed = applyMemoryLimits();
+    changed |= applyCommands();
+    changed |= applyBackfills();
+    applyExports();
+    changed |= m_replayed;
+    m_replayed = false;
+    changed |= m_ticker.isReaggregating();  // This step's slice adds candles
+    
+    // Publish only when the data clock advanced (frames faster than the
+    // tick step often run no step at all)
+    if (m_ticker.update(deltaTime) > 0 || changed)
+        publish();
+    publishMemoryUsage();
+}
+
+bool DataPipeline::applyMemoryLimits()
+{
+    if (!m_limitsPosted.exchange(false, std::memory_order_acquire))
+        return false;
+    
+    bool changed = false;
+    for (int i = 0; i < STORE_COUNT; i++)
+    {
+        size_t limit = m_storeLimits[i].load(std::memory_order_relaxed);
+        if (limit == m_appliedLimits[i])
+            continue;
+        m_appliedLimits[i] = limit;
+        
+        if (i != STORE_CANDLES)
+        {
+            m_ticker.limitHistory((HistoryTier)i, limit);
+            continue;
+        }
+        
+        // Largest power of two that fits every copy, within the floor and
+        // the default capacity
+        size_t fit = limit / ((1 + SNAPSHOT_COPIES) * sizeof(Candle));
+        int capacity = MIN_STORE_RECORDS;
+        while (capacity < CandleBuffer::MAX_CANDLES && (size_t)capacity * 2 <= fit)
+            capacity <<= 1;
+        m_ticker.setCandleCapacity(capacity);
+        changed = true;
+    }
+    return changed;
+}
+
+void DataPipeline::publishMemoryUsage()
+{
+    const TieredHistory& history = m_ticker.getHistory();
+    for (int t = 0; t < TIER_COUNT; t++)
+        m_storeBytes[t].store(history.reservedBytes((HistoryTier)t), std::memory_order_relaxed);
+    
+    size_t candleBytes = (size_t)m_ticker.getCandleBuffer().capacity() * sizeof(Candle);
+    m_storeBytes[STORE_CANDLES].store(candleBytes * (1 + SNAPSHOT_COPIES), std::memory_order_relaxed);
+}
+
+bool DataPipeline::applyCommands()
+{
+    bool changed = false;
+    uint64_t policy = m_policyCommand.exchange(0, std::memory_order_acquire);
+    if (policy & COMMAND_PENDING)
+    {
+        // Held ticks are applied under the old policy
+        m_ticker.setTickPolicy((TickPolicy)(policy >> COMMAND_POLICY_SHIFT & 3), commandValue(policy));
+        changed = true;
+    }
+    
+    uint64_t command = m_command.exchange(0, std::memory_order_acquire);
+    if ((command & COMMAND_PENDING) == 0)
+        return changed;
+    
+    m_ticker.setCandleInterval(commandValue(command), (command & COMMAND_PRESERVE) != 0);
+    return true;
+}
+
+bool DataPipeline::applyBackfills()
+{
+    BackfillBatch* batch = m_backfills.exchange(nullptr, std::memory_order_acquire);
+    if (!batch)
+        return false;
+    
+    // The list is newest first; apply in posting order
+    BackfillBatch* ordered = nullptr;
+    while (batch)
+    {
+        BackfillBatch* next = batch->next;
+        batch->next = ordered;
+        ordered = batch;
+        batch = next;
+    }
+    
+    while (ordered)
+    {
+        BackfillBatch* next = ordered->next;
+        m_ticker.backfill(ordered->candles.data(), (int)ordered->candles.size(),
+                          ordered->ticks.data(), (int)ordered->ticks.size());
+        delete ordered;
+        ordered = next;
+    }
+    return true;
+}
+
+void DataPipeline::applyExports()
+{
+    ExportRequest* request = m_exports.exchange(nullptr, std::memory_order_acquire);
+    
+    // Newest first; order does not matter between files
+    while (request)
+    {
+        ExportRequest* next = request->next;
+        writeExport(*request);
+        delete request;
+        request = next;
+    }
+}
+
+bool DataPipeline::writeExport(const ExportRequest& request)
+{
+    int64_t bytes = writeColumnFile(request.path, m_ticker.getCandleBuffer(), m_ticker.getTickHistory(),
+                                    secondsToNs(m_ticker.getCandleInterval()),
+                                    m_ticker.getPriceScale().tickSize, request.compress);
+    if (bytes < 0)
+    {
+        m_exportErrors->add();
+        return false;
+    }
+    m_exportFiles->add();
+    m_exportBytes->add(bytes);
+    return true;
+}
+
+void DataPipeline::publish()
+{
+    ChartSnapshot& back = m_snapshots.back();
+    back.sequence = ++m_sequence;
+    back.candles.copyFrom(m_ticker.getCandleBuffer());
+    back.currentCandle = m_ticker.getCurrentCandle();
+    back.currentPrice = m_ticker.getCurrentPrice();
+    back.priceScale = m_ticker.getPriceScale();
+    back.candleInterval = m_ticker.getCandleInterval();
+    back.ticksPerSecond = m_ticker.getTicksPerSecond();
+    back.reaggregateProgress = m_ticker.getReaggregateProgress();
+    m_snapshotsPublished->add();
+    
+    // The recycled slot starts with no stamps, unless the reader skipped it:
+    // its stamps then carry over into the next snapshot
+    if (m_snapshots.publish())
+        m_snapshots.back().ingestStampCount = 0;
+    else
+        m_snapshotsSkipped->add();
+}
+
+void DataPipeline::workerMain()
+{
+#if DATA_PIPELINE_THREADS
+    double lastMs = platformNowMs();
+    while (m_running.load())
+    {
+        double nowMs = platformNowMs();
+        float deltaTime = (float)((nowMs - lastMs) / 1000.0);
+        lastMs = nowMs;
+        
+        step(deltaTime);
+        
+        std::this_thread::sleep_for(std::chrono::microseconds(WORKER_PERIOD_US));
+    }
+#endif
+}
+
+void BackfillBatch::shiftToEnd(TimeNs end, TimeNs candleIntervalNs)
+{
+    if (candles.empty() && ticks.empty())
+        return;
+    
+    TimeNs dataEnd = candles.empty() ? ticks.back().timestamp + 1 : candles.back().time + candleIntervalNs;
+    if (!candles.empty() && !ticks.empty() && ticks.back().timestamp >= dataEnd)
+        dataEnd += ((ticks.back().timestamp - dataEnd) / candleIntervalNs + 1) * candleIntervalNs;
+    
+    TimeNs shift = end - dataEnd;
+    for (Candle& candle : candles)
+        candle.time += shift;
+    for (Tick& tick : ticks)
+        tick.timestamp += shift;
+}
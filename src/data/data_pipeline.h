@@ -0,0 +1,195 @@
+#pragma once
+
+#include "mock_ticker.h"
+#include "triple_buffer.h"
+#include "../chart/chart_snapshot.h"
+#include "../perf/latency_tracker.h"
+#include "../perf/memory_budget.h"
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+// Worker threads are available natively and in WASM builds linked with -pthread
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define DATA_PIPELINE_THREADS 1
+#include <thread>
+#else
+#define DATA_PIPELINE_THREADS 0
+#endif
+
+// ============================================================================
+// DATA PIPELINE
+// Owns the ticker and publishes a ChartSnapshot whenever a step changed the
+// data. Runs inline (update() on the render thread) or on a worker thread,
+// keeping tick generation and aggregation (including interval
+// re-aggregation) off the frame. Snapshots go through a triple buffer and
+// commands through an atomic slot, so neither thread blocks on the other.
+// Snapshot candle buffers are updated incrementally (CandleBuffer::copyFrom),
+// so long histories cost only the newly closed candles per publish.
+// ============================================================================
+
+// Stores the pipeline sizes under a memory budget (see
+// DataPipeline::registerMemory)
+enum PipelineStore
+{
+    STORE_TICKS,        // Tiered history, in HistoryTier order
+    STORE_SECONDS,
+    STORE_MINUTES,
+    STORE_CANDLES,      // Candle series and its snapshot copies
+    STORE_COUNT
+};
+
+// Historical data handed to the producer in one piece (see
+// DataPipeline::backfill and MockTicker::backfill)
+struct BackfillBatch
+{
+    std::vector<Candle> candles;    // Ascending time, at the current candle interval
+    std::vector<Tick> ticks;        // Optional, ascending time
+    BackfillBatch* next;            // Pending list link, owned by the pipeline
+    
+    BackfillBatch() : next(nullptr) {}
+    
+    // Move all times so the data ends at `end` (the live data clock starts
+    // at 0): past the last candle, extended by whole intervals to cover
+    // later ticks, so candles stay on their interval grid
+    void shiftToEnd(TimeNs end, TimeNs candleIntervalNs);
+};
+
+// Column file export posted to the producer (see DataPipeline::exportData)
+struct ExportRequest
+{
+    char path[256];
+    bool compress;
+    ExportRequest* next;
+    
+    ExportRequest() : compress(false), next(nullptr) { path[0] = '\0'; }
+};
+
+class DataPipeline : private TickStampSink
+{
+public:
+    static constexpr int WORKER_PERIOD_US = 16667;  // Worker step cadence (~60 Hz, like inline)
+    static const int SNAPSHOT_COPIES = 3;           // Triple buffer slots, each holding the candle series
+    static const int MIN_STORE_RECORDS = 4096;      // Floor under a budget: ticks/candles per tier, candles per copy
+    
+    DataPipeline();
+    ~DataPipeline();
+    
+    // Start the worker thread (returns false when built without threads)
+    bool startWorker();
+    void stopWorker();
+    bool isThreaded() const { return m_threaded; }
+    
+    // Inline mode: advance the ticker and publish (no-op while threaded)
+    void update(float deltaTime);
+    
+    // Change the candle interval; applied on the producer's next step.
+    // Preserved history is re-aggregated within budgetMs per step (see
+    // MockTicker::setCandleInterval); set the budget before startWorker().
+    void setCandleInterval(float interval, bool preserveHistory);
+    void setReaggregateBudget(double budgetMs) { m_ticker.setReaggregateBudget(budgetMs); }
+    
+    // History retention per tier (see tiered_history.h); before startWorker()
+    void configureHistory(HistoryTier tier, const TieredHistory::TierConfig& config) { m_ticker.configureHistory(tier, config); }
+    
+    // Out-of-order tick handling and the simulated feed (see
+    // MockTicker::setReorderWindow, setFeedJitter, setFeedRate); before
+    // startWorker()
+    void setReorderWindow(double ms) { m_ticker.setReorderWindow(ms); }
+    void setFeedJitter(double ms) { m_ticker.setFeedJitter(ms); }
+    void setFeedRate(int ticksPerStep) { m_ticker.setFeedRate(ticksPerStep); }
+    
+    // Overload policy for ticks (see tick_throttle.h); applied on the
+    // producer's next step, safe from any thread
+    void setTickPolicy(TickPolicy policy, double windowMs);
+    
+    // Memory budget hooks, safe from any thread. Usage is published by the
+    // producer after each step, limits are applied on its next step.
+    size_t getMemoryUsage(PipelineStore store) const { return m_storeBytes[store].load(std::memory_order_relaxed); }
+    void setMemoryLimit(PipelineStore store, size_t limitBytes);
+    
+    // Add the stores to a budget: tick and 1s history as detail (coarser
+    // tiers keep summarizing it), the candle series, then 1m history
+    void registerMemory(MemoryBudget& budget);
+    
+    // Prepend historical data; takes ownership of a heap-allocated batch.
+    // Applied on the producer's next step, after a pending interval change,
+    // and published with that step's snapshot. Safe from any thread.
+    void backfill(BackfillBatch* batch);
+    
+    // Write finalized candles and tick history as a column file (see
+    // column_file.h). Inline: written now, returns the result. Threaded:
+    // written on the producer's next step, returns true once queued.
+    bool exportData(const char* path, bool compress);
+    
+    // Journal hooks; call before startWorker(). The recorder sees every
+    // generated tick on the producer. Replayed ticks (journal recovery)
+    // rebuild the ticker's state and are published with the next step.
+    void setTickRecorder(TickRecorder* recorder) { m_ticker.setTickRecorder(recorder); }
+    void replayTicks(const Tick* ticks, int count);
+    const PriceScale& getPriceScale() const { return m_ticker.getPriceScale(); }
+    
+    // Render thread, once per frame: adopt the newest snapshot and report the
+    // ticks it made visible to the latency tracker. The returned snapshot
+    // stays valid and unchanged until the next acquire().
+    const ChartSnapshot& acquire();
+    
+    void setLatencyTracker(LatencyTracker* tracker) { m_latencyTracker = tracker; }
+    
+private:
+    // Producer side: touched only by the worker, or by update() when inline
+    MockTicker m_ticker;
+    uint64_t m_sequence;
+    
+    TripleBuffer<ChartSnapshot> m_snapshots;
+    LatencyTracker* m_latencyTracker;   // Render side, not owned
+    
+    // Pending interval and tick policy changes, see encodeCommand()
+    std::atomic<uint64_t> m_command;
+    std::atomic<uint64_t> m_policyCommand;
+    
+    // Posted backfill batches, newest first (lock-free list)
+    std::atomic<BackfillBatch*> m_backfills;
+    std::atomic<ExportRequest*> m_exports;
+    bool m_replayed;    // Replayed ticks not yet published
+    
+    bool m_threaded;
+    std::atomic<bool> m_running;
+#if DATA_PIPELINE_THREADS
+    std::thread m_worker;
+#endif
+
+    // Memory budget state: limits posted by the governor, usage published
+    // by the producer
+    struct MemoryHook
+    {
+        DataPipeline* pipeline;
+        PipelineStore store;
+    };
+    MemoryHook m_memoryHooks[STORE_COUNT];
+    std::atomic<size_t> m_storeBytes[STORE_COUNT];
+    std::atomic<size_t> m_storeLimits[STORE_COUNT];
+    std::atomic<bool> m_limitsPosted;
+    size_t m_appliedLimits[STORE_COUNT];    // Producer side
+    
+    Metric* m_snapshotsPublished;
+    Metric* m_snapshotsSkipped;
+    Metric* m_stampsDropped;
+    Metric* m_exportFiles;
+    Metric* m_exportBytes;
+    Metric* m_exportErrors;
+    
+    void onTickVisible(double ingestTimeMs) override;
+    void step(float deltaTime);
+    bool applyCommands();
+    bool applyBackfills();
+    bool applyMemoryLimits();
+    void publishMemoryUsage();
+    void applyExports();
+    bool writeExport(const ExportRequest& request);
+    void publish();
+    void workerMain();
+    
+    static size_t storeUsage(void* user);
+    static void limitStore(void* user, size_t limitBytes);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================================
+// MARKET TYPES
+// Integer time and price representation shared by ticks and candles.
+// Timestamps are nanoseconds on the data clock; prices are whole multiples of
+// the instrument's tick size, so aggregation math is exact integer math.
+// ============================================================================
+
+typedef int64_t TimeNs;       // Nanoseconds since data clock start
+typedef int32_t PriceTicks;   // Price in units of PriceScale::tickSize
+
+static const TimeNs NS_PER_SECOND = 1000000000;
+
+inline TimeNs secondsToNs(double seconds) { return (TimeNs)llround(seconds * NS_PER_SECOND); }
+inline double nsToSeconds(TimeNs ns) { return (double)ns / NS_PER_SECOND; }
+
+// Start of the interval containing t, on a grid anchored at time 0 (also
+// for negative times, e.g. history before the data clock started)
+inline TimeNs floorToInterval(TimeNs t, TimeNs interval)
+{
+    TimeNs q = t / interval;
+    if (t % interval < 0) q--;
+    return q * interval;
+}
+
+// Instrument price grid (configurable tick size)
+struct PriceScale
+{
+    double tickSize;    // Smallest price increment, e.g. 0.01
+    
+    PriceScale() : tickSize(0.01) {}
+    explicit PriceScale(double size) : tickSize(size) {}
+    
+    float toPrice(PriceTicks ticks) const { return (float)(ticks * tickSize); }
+    PriceTicks toTicks(double price) const { return (PriceTicks)llround(price / tickSize); }
+};
@@ -1,17 +1,49 @@
 #include "mock_ticker.h"
 #include <stdlib.h>
+#include <math.h>
+#include "../platform/platform.h"
 
 MockTicker::MockTicker()
-    : m_currentPrice(100.0f)
+    : m_walkPrice(100.0f)
+    , m_lastPrice(0)
     , m_volatility(0.5f)
     , m_candleInterval(1.0f)
     , m_initialized(false)
-    , m_elapsedTime(0.0f)
-    , m_candleTimer(0.0f)
-    , m_tickCount(0)
-    , m_tickRateTimer(0.0f)
-    , m_ticksPerSecond(0.0f)
+    , m_stepCount(0)
+    , m_accumulator(0.0)
+    , m_reorderWindowNs(0)
+    , m_feedJitterNs(0)
+    , m_lastTickTime(0)
+    , m_ticksPerStep(1)
+    , m_candleStartStep(0)
+    , m_reaggregating(false)
+    , m_reaggregateBudgetMs(REAGGREGATE_BUDGET_MS)
+    , m_reaggregateIntervalNs(0)
+    , m_reaggregateBefore(0)
+    , m_reaggregateFrom(0)
+    , m_reaggregateOldest(0)
+    , m_stampSink(nullptr)
+    , m_recorder(nullptr)
 {
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_ticksIngested = metrics.rate("ticks.ingested");
+    m_candlesFinalized = metrics.counter("candles.finalized");
+    m_reaggregations = metrics.counter("candles.reaggregations");
+    m_reaggregateSlices = metrics.counter("candles.reaggregate_slices");
+    m_candlesBackfilled = metrics.counter("candles.backfilled");
+    m_ticksBackfilled = metrics.counter("ticks.backfilled");
+    m_candleCount = metrics.gauge("candles.count");
+    m_candleCapacity = metrics.gauge("candles.capacity");
+    m_candleCapacity->set(m_candleBuffer.maxCandles());
+    m_catchUpTicks = metrics.counter("ticker.catchup_ticks");
+    m_ticksReordered = metrics.counter("ticks.reordered");
+    m_lateTicks = metrics.counter("ticks.late");
+    m_candlesCorrected = metrics.counter("candles.corrected");
+    m_ticksConflated = metrics.counter("ticks.conflated");
+    m_ticksDropped = metrics.counter("ticks.dropped");
+    m_tickPolicy = metrics.gauge("ticks.policy");
+    m_tickPolicyWindow = metrics.gauge("ticks.policy_window_ms");
+    m_catchUpBacklogGauge = metrics.gauge("ticker.catchup_backlog_s");
 }
 
 float MockTicker::randomWalk()
@@ -19,51 +51,263 @@ float MockTicker::randomWalk()
     return ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f;
 }
 
-void MockTicker::update(float deltaTime)
+void MockTicker::initialize()
+{
+    srand(42);  // Fixed seed for reproducibility
+    m_walkPrice = 100.0f;
+    m_lastPrice = m_priceScale.toTicks(m_walkPrice);
+    m_currentCandle = Candle(stepToNs(m_candleStartStep), m_lastPrice, m_lastPrice, m_lastPrice, m_lastPrice);
+    m_initialized = true;
+}
+
+int MockTicker::update(float deltaTime)
 {
     // Initialize on first call
     if (!m_initialized)
+        initialize();
+    
+    if (m_reaggregating)
+        continueReaggregation(m_reaggregateBudgetMs);
+    
+    // Consume frame time in whole fixed steps, capped per update
+    m_accumulator += deltaTime;
+    int steps = (int)(m_accumulator / TICK_STEP);
+    if (steps > MAX_STEPS_PER_UPDATE) steps = MAX_STEPS_PER_UPDATE;
+    
+    for (int i = 0; i < steps; i++)
+    {
+        step();
+    }
+    m_accumulator -= steps * TICK_STEP;
+    
+    // Age history out into coarser tiers
+    m_history.compact(getElapsedTime());
+    
+    if (steps > CATCHUP_STEPS)
+        m_catchUpTicks->add(steps);
+    m_catchUpBacklogGauge->set(m_accumulator);
+    return steps;
+}
+
+uint64_t MockTicker::intervalSteps() const
+{
+    return (uint64_t)llround(m_candleInterval / TICK_STEP);
+}
+
+void MockTicker::setTickPolicy(TickPolicy policy, double windowMs)
+{
+    // Held ticks belong to the old policy's window
+    flushConflated(false);
+    m_throttle.setPolicy(policy, secondsToNs(windowMs / 1000.0));
+    m_tickPolicy->set(policy);
+    m_tickPolicyWindow->set(policy == TICK_KEEP_ALL ? 0.0 : nsToSeconds(m_throttle.getWindow()) * 1000.0);
+}
+
+void MockTicker::step()
+{
+    m_stepCount++;
+    TimeNs now = getElapsedTime();
+    
+    for (int i = 0; i < m_ticksPerStep; i++)
+    {
+        // Random walk price update (volatility per step, spread over its ticks)
+        float priceChange = randomWalk() * m_volatility * (float)(TICK_STEP * 60.0);
+        if (m_ticksPerStep > 1)
+            priceChange /= sqrtf((float)m_ticksPerStep);
+        m_walkPrice += priceChange;
+        
+        // Clamp price to reasonable range
+        if (m_walkPrice < 10.0f) m_walkPrice = 10.0f;
+        if (m_walkPrice > 500.0f) m_walkPrice = 500.0f;
+        
+        // Stamped on arrival, or up to the simulated feed delay before it
+        TimeNs stamp = now - stepToNs(1) * (m_ticksPerStep - 1 - i) / m_ticksPerStep;
+        if (m_feedJitterNs > 0)
+            stamp -= (TimeNs)((double)rand() / RAND_MAX * m_feedJitterNs);
+        if (stamp < 0) stamp = 0;
+        
+        Tick tick(m_priceScale.toTicks(m_walkPrice), stamp);
+        m_ticksIngested->add();
+        
+        if (m_recorder)
+            m_recorder->record(tick);
+        
+        ingestTick(StampedTick(tick, platformNowMs()), true);
+    }
+    releaseTicks(now - m_reorderWindowNs, true);
+}
+
+void MockTicker::replayTicks(const Tick* ticks, int count)
+{
+    if (!m_initialized)
+        initialize();
+    
+    for (int i = 0; i < count; i++)
     {
-        srand(42);  // Fixed seed for reproducibility
-        m_currentPrice = 100.0f;
-        m_currentCandle = Candle(m_currentPrice, m_currentPrice, m_currentPrice, m_currentPrice);
-        m_initialized = true;
+        uint64_t tickStep = nsToStep(ticks[i].timestamp);
+        if (tickStep > m_stepCount)
+            m_stepCount = tickStep;
+        
+        ingestTick(StampedTick(ticks[i], 0.0), false);
+        releaseTicks(getElapsedTime() - m_reorderWindowNs, false);
     }
     
-    // Update elapsed time
-    m_elapsedTime += deltaTime;
+    // Continue the random walk from the last replayed price
+    m_walkPrice = m_priceScale.toPrice(m_lastPrice);
+    m_history.compact(getElapsedTime());
+}
+
+// Sort an arrival into the reorder buffer, or correct with it when it is
+// too late for that. Live ticks are reported to the stamp sink once they
+// reach the candles.
+void MockTicker::ingestTick(const StampedTick& stamped, bool live)
+{
+    // Full: the oldest ticks are released early
+    if (m_reorder.full())
+        releaseTicks(m_reorder.oldest().tick.timestamp, live);
     
-    // Track tick rate
-    m_tickCount++;
-    m_tickRateTimer += deltaTime;
-    if (m_tickRateTimer >= 1.0f)
+    if (m_reorder.isLate(stamped.tick))
     {
-        m_ticksPerSecond = (float)m_tickCount / m_tickRateTimer;
-        m_tickCount = 0;
-        m_tickRateTimer = 0.0f;
+        correctLateTick(stamped.tick);
+        if (live && m_stampSink)
+            m_stampSink->onTickVisible(stamped.ingestTime);
+        return;
+    }
+    
+    if (!m_reorder.insert(stamped))
+        m_ticksReordered->add();
+}
+
+// Apply held ticks stamped at or before upTo in time order. Their time
+// range is final, so candles ending by then close.
+void MockTicker::releaseTicks(TimeNs upTo, bool live)
+{
+    while (m_reorder.count() > 0 && m_reorder.oldest().tick.timestamp <= upTo)
+    {
+        StampedTick stamped = m_reorder.oldest();
+        m_reorder.popOldest();
+        admitTick(stamped, live);
+    }
+    m_reorder.advance(upTo);
+    
+    // Held ticks are complete once the watermark passed their window or
+    // candle
+    if (m_throttle.heldCount() > 0 && (m_throttle.windowEnd() <= upTo || candleEnd() <= upTo))
+        flushConflated(live);
+    
+    while (candleEnd() <= upTo)
+    {
+        finalizeCandle();
+    }
+}
+
+// Pass a released tick (time order) through the overload policy. A window
+// never spans a candle boundary: a tick at or after the end of the candle
+// holding the window's first tick opens a new window.
+void MockTicker::admitTick(const StampedTick& stamped, bool live)
+{
+    TickPolicy policy = m_throttle.getPolicy();
+    if (policy != TICK_KEEP_ALL)
+    {
+        if (m_throttle.inWindow(stamped.tick) && stamped.tick.timestamp < candleEnd())
+        {
+            if (policy == TICK_CONFLATE)
+                m_throttle.hold(stamped);
+            else
+                m_ticksDropped->add();
+            return;
+        }
+        flushConflated(live);
+        m_throttle.open(stamped.tick);
     }
+    emitTick(stamped, live);
+}
+
+// Apply what summarizes the held ticks (their high, low and last)
+void MockTicker::flushConflated(bool live)
+{
+    StampedTick ticks[TickThrottle::MAX_FLUSH];
+    int held = m_throttle.heldCount();
+    int n = m_throttle.flush(ticks);
+    for (int i = 0; i < n; i++)
+        emitTick(ticks[i], live);
+    m_ticksConflated->add(held - n);
+}
+
+void MockTicker::emitTick(const StampedTick& stamped, bool live)
+{
+    applyTick(stamped.tick);
     
-    // Random walk price update (volatility scaled by time)
-    float priceChange = randomWalk() * m_volatility * deltaTime * 60.0f;
-    m_currentPrice += priceChange;
+    // Renderable as soon as it is applied (inline) or published (worker)
+    if (live && m_stampSink)
+        m_stampSink->onTickVisible(stamped.ingestTime);
+}
+
+// Store a released tick (time order) and fold it into the forming candle
+void MockTicker::applyTick(const Tick& tick)
+{
+    // Candles ending at or before the tick are complete
+    while (tick.timestamp >= candleEnd())
+    {
+        finalizeCandle();
+    }
     
-    // Clamp price to reasonable range
-    if (m_currentPrice < 10.0f) m_currentPrice = 10.0f;
-    if (m_currentPrice > 500.0f) m_currentPrice = 500.0f;
+    m_lastPrice = tick.price;
+    m_lastTickTime = tick.timestamp;
     
     // Store tick in history for potential re-aggregation
-    m_tickHistory.push(Tick(m_currentPrice, m_elapsedTime));
+    m_history.append(tick);
     
     // Update current forming candle
-    m_currentCandle.close = m_currentPrice;
-    if (m_currentPrice > m_currentCandle.high) m_currentCandle.high = m_currentPrice;
-    if (m_currentPrice < m_currentCandle.low) m_currentCandle.low = m_currentPrice;
+    m_currentCandle.close = m_lastPrice;
+    if (m_lastPrice > m_currentCandle.high) m_currentCandle.high = m_lastPrice;
+    if (m_lastPrice < m_currentCandle.low) m_currentCandle.low = m_lastPrice;
+}
+
+// A tick stamped before the reorder watermark: history and the candle
+// covering its time are corrected in place
+void MockTicker::correctLateTick(const Tick& tick)
+{
+    m_lateTicks->add();
+    m_history.insertLate(tick);
     
-    // Check if candle interval elapsed
-    m_candleTimer += deltaTime;
-    if (m_candleTimer >= m_candleInterval)
+    // Newer than every applied tick (they left a gap): the new last price
+    bool newest = tick.timestamp >= m_lastTickTime;
+    if (newest)
     {
-        finalizeCandle();
+        m_lastPrice = tick.price;
+        m_lastTickTime = tick.timestamp;
+    }
+    
+    if (tick.timestamp >= m_currentCandle.time)
+    {
+        if (tick.price > m_currentCandle.high) m_currentCandle.high = tick.price;
+        if (tick.price < m_currentCandle.low) m_currentCandle.low = tick.price;
+        if (newest) m_currentCandle.close = tick.price;
+        return;
+    }
+    
+    // The finalized candle covering its time, when resident
+    TimeNs intervalNs = stepToNs(intervalSteps());
+    int index = upperBoundTime(m_candleBuffer, tick.timestamp) - 1;
+    if (index < 0 || tick.timestamp >= m_candleBuffer.get(index).time + intervalNs)
+        return;
+    
+    Candle candle = m_candleBuffer.get(index);
+    if (tick.price > candle.high) candle.high = tick.price;
+    if (tick.price < candle.low) candle.low = tick.price;
+    
+    // The close moves only when no later tick of the candle is known
+    const TickHistory& ticks = m_history.ticks();
+    bool covered = ticks.count() > 0 && ticks.getStartTime() <= tick.timestamp;
+    if (newest || (covered && ticks.queryRange(tick.timestamp + 1, candle.time + intervalNs).empty()))
+        candle.close = tick.price;
+    
+    const Candle& before = m_candleBuffer.get(index);
+    if (candle.high != before.high || candle.low != before.low || candle.close != before.close)
+    {
+        m_candleBuffer.correct(index, candle);
+        m_candlesCorrected->add();
     }
 }
 
@@ -72,6 +316,9 @@ void MockTicker::setCandleInterval(float interval, bool preserveHistory)
     if (interval <= 0.0f) return;
     if (interval == m_candleInterval) return;
     
+    // Conflated ticks go into history before it is re-read
+    flushConflated(false);
+    
     if (preserveHistory)
     {
         // Re-aggregate all candles from tick history
@@ -80,85 +327,141 @@ void MockTicker::setCandleInterval(float interval, bool preserveHistory)
     else
     {
         // Clear mode: just clear candles and start fresh
-        clearCandles();
         m_candleInterval = interval;
+        clearCandles();
     }
 }
 
 void MockTicker::clearCandles()
 {
-    // Clear the candle buffer by creating a new one
-    m_candleBuffer = CandleBuffer();
+    // Drop the candle series (tiered history is kept)
+    m_reaggregating = false;
+    m_candleBuffer.clear();
+    m_candleCount->set(0);
+    
+    // The forming candle is the bucket, on the grid anchored at time 0, of
+    // where released data ends (held ticks are newer)
+    TimeNs released = m_reorder.getWatermark();
+    TimeNs formingStart = floorToInterval(released > 0 ? released : 0, secondsToNs(m_candleInterval));
+    m_candleStartStep = nsToStep(formingStart);
+    if (m_candleStartStep > m_stepCount) m_candleStartStep = m_stepCount;
+    m_currentCandle = Candle(stepToNs(m_candleStartStep), m_lastPrice, m_lastPrice, m_lastPrice, m_lastPrice);
+}
+
+void MockTicker::setCandleCapacity(int capacity)
+{
+    m_candleBuffer.setCapacity(capacity);
+    m_candleCount->set(m_candleBuffer.count());
+    m_candleCapacity->set(m_candleBuffer.maxCandles());
+}
+
+int MockTicker::backfill(const Candle* candles, int candleCount, const Tick* ticks, int tickCount)
+{
+    // Backfilled candles go in front of the re-aggregated ones
+    if (m_reaggregating)
+        continueReaggregation(0.0);
     
-    // Reset current candle
-    m_currentCandle = Candle(m_currentPrice, m_currentPrice, m_currentPrice, m_currentPrice);
-    m_candleTimer = 0.0f;
+    int ticksAdded = m_history.backfill(ticks, tickCount, getElapsedTime());
+    m_ticksBackfilled->add(ticksAdded);
+    m_history.compact(getElapsedTime());
+    
+    int candlesAdded = m_candleBuffer.backfill(candles, candleCount, stepToNs(m_candleStartStep));
+    m_candlesBackfilled->add(candlesAdded);
+    m_candleCount->set(m_candleBuffer.count());
+    return candlesAdded;
+}
+
+float MockTicker::getReaggregateProgress() const
+{
+    if (!m_reaggregating || m_reaggregateFrom <= m_reaggregateOldest)
+        return 1.0f;
+    return (float)((double)(m_reaggregateFrom - m_reaggregateBefore) / (double)(m_reaggregateFrom - m_reaggregateOldest));
 }
 
 void MockTicker::reaggregateFromHistory(float newInterval)
 {
+    m_reaggregations->add();
+    
     // Clear existing candles
-    m_candleBuffer = CandleBuffer();
+    m_candleBuffer.clear();
+    m_candleCount->set(0);
+    m_candleInterval = newInterval;
+    m_reaggregating = false;
     
-    int tickCount = m_tickHistory.count();
-    if (tickCount == 0)
+    TimeNs intervalNs = secondsToNs(newInterval);
+    TimeNs oldest, newest;
+    if (!m_history.getTimeRange(intervalNs, oldest, newest))
     {
-        m_candleInterval = newInterval;
-        m_candleTimer = 0.0f;
-        m_currentCandle = Candle(m_currentPrice, m_currentPrice, m_currentPrice, m_currentPrice);
+        clearCandles();
         return;
     }
     
-    // Get the start time of our history
-    float startTime = m_tickHistory.getStartTime();
-    float currentCandleStart = startTime;
+    // The newest data's bucket becomes the forming candle, rebuilt now (one
+    // interval of history) so live ticks continue at the new interval
+    TimeNs formingStart = floorToInterval(newest, intervalNs);
+    m_reaggregateCandles.clear();
+    m_history.aggregate(formingStart, formingStart + intervalNs, intervalNs, m_reaggregateCandles);
+    m_currentCandle = m_reaggregateCandles.empty()
+        ? Candle(formingStart, m_lastPrice, m_lastPrice, m_lastPrice, m_lastPrice)
+        : m_reaggregateCandles[0];
     
-    // Initialize first candle from first tick
-    Tick firstTick = m_tickHistory.get(0);
-    Candle candle(firstTick.price, firstTick.price, firstTick.price, firstTick.price);
+    // Resume the forming candle on the step grid
+    m_candleStartStep = nsToStep(formingStart);
+    if (m_candleStartStep > m_stepCount) m_candleStartStep = m_stepCount;
     
-    // Iterate through all ticks and aggregate into candles
-    for (int i = 1; i < tickCount; i++)
+    // Everything older is aggregated by continueReaggregation()
+    m_reaggregateIntervalNs = intervalNs;
+    m_reaggregateBefore = formingStart;
+    m_reaggregateFrom = formingStart;
+    m_reaggregateOldest = floorToInterval(oldest, intervalNs);
+    m_reaggregating = m_reaggregateOldest < formingStart;
+    if (m_reaggregating && m_reaggregateBudgetMs <= 0.0)
+        continueReaggregation(0.0);
+}
+
+void MockTicker::continueReaggregation(double budgetMs)
+{
+    m_reaggregateSlices->add();
+    double deadline = platformNowMs() + budgetMs;
+    
+    // Slices of whole intervals, newest to oldest, so every candle is
+    // complete when prepended in front of the resident ones
+    TimeNs intervalNs = m_reaggregateIntervalNs;
+    TimeNs oldest, newest;
+    while (m_history.getTimeRange(intervalNs, oldest, newest) && m_reaggregateBefore > oldest)
     {
-        const Tick& tick = m_tickHistory.get(i);
+        TimeNs from = m_reaggregateBefore - REAGGREGATE_SLICE * intervalNs;
+        if (from < floorToInterval(oldest, intervalNs))
+            from = floorToInterval(oldest, intervalNs);
         
-        // Check if this tick belongs to the current candle or starts a new one
-        float tickCandleStart = startTime + ((int)((tick.timestamp - startTime) / newInterval)) * newInterval;
+        m_reaggregateCandles.clear();
+        int n = m_history.aggregate(from, m_reaggregateBefore, intervalNs, m_reaggregateCandles);
+        m_reaggregateBefore = from;
         
-        if (tickCandleStart > currentCandleStart)
-        {
-            // Finalize current candle
-            m_candleBuffer.push(candle);
-            
-            // Start new candle
-            currentCandleStart = tickCandleStart;
-            candle = Candle(tick.price, tick.price, tick.price, tick.price);
-        }
-        else
+        // A full buffer takes no more history
+        if (m_candleBuffer.backfill(m_reaggregateCandles.data(), n, stepToNs(m_candleStartStep)) < n)
+            break;
+        
+        if (budgetMs > 0.0 && platformNowMs() >= deadline)
         {
-            // Update current candle with this tick
-            candle.close = tick.price;
-            if (tick.price > candle.high) candle.high = tick.price;
-            if (tick.price < candle.low) candle.low = tick.price;
+            m_candleCount->set(m_candleBuffer.count());
+            return;
         }
     }
     
-    // The last candle becomes the current forming candle
-    m_currentCandle = candle;
-    m_candleInterval = newInterval;
-    
-    // Calculate how much time has passed in the current candle
-    float lastTickTime = m_tickHistory.get(tickCount - 1).timestamp;
-    m_candleTimer = lastTickTime - currentCandleStart;
+    m_candleCount->set(m_candleBuffer.count());
+    m_reaggregating = false;
 }
 
 void MockTicker::finalizeCandle()
 {
-    m_candleTimer -= m_candleInterval;
+    m_candleStartStep += intervalSteps();
     
     // Push completed candle to buffer
     m_candleBuffer.push(m_currentCandle);
+    m_candlesFinalized->add();
+    m_candleCount->set(m_candleBuffer.count());
     
     // Start new candle
-    m_currentCandle = Candle(m_currentPrice, m_currentPrice, m_currentPrice, m_currentPrice);
+    m_currentCandle = Candle(stepToNs(m_candleStartStep), m_lastPrice, m_lastPrice, m_lastPrice, m_lastPrice);
 }
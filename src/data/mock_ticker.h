@@ -1,78 +1,12 @@
 #pragma once
 
 #include "../chart/candle.h"
-
-// ============================================================================
-// TICK DATA - Raw price data with timestamp
-// ============================================================================
-
-struct Tick
-{
-    float price;
-    float timestamp;  // Elapsed time since start
-    
-    Tick() : price(0), timestamp(0) {}
-    Tick(float p, float t) : price(p), timestamp(t) {}
-};
-
-// ============================================================================
-// TICK HISTORY - Ring buffer for storing raw tick data
-// ============================================================================
-
-class TickHistory
-{
-public:
-    static const int MAX_TICKS = 36000;  // Store up to 10 minutes at 60fps
-    
-    TickHistory() : m_count(0), m_start(0) {}
-    
-    void push(const Tick& tick)
-    {
-        if (m_count < MAX_TICKS)
-        {
-            m_ticks[m_count] = tick;
-            m_count++;
-        }
-        else
-        {
-            m_ticks[m_start] = tick;
-            m_start = (m_start + 1) % MAX_TICKS;
-        }
-    }
-    
-    const Tick& get(int index) const
-    {
-        int actualIndex = (m_start + index) % MAX_TICKS;
-        return m_ticks[actualIndex];
-    }
-    
-    int count() const { return m_count; }
-    
-    void clear()
-    {
-        m_count = 0;
-        m_start = 0;
-    }
-    
-    // Get earliest timestamp in history
-    float getStartTime() const
-    {
-        if (m_count == 0) return 0.0f;
-        return get(0).timestamp;
-    }
-    
-    // Get latest timestamp in history
-    float getEndTime() const
-    {
-        if (m_count == 0) return 0.0f;
-        return get(m_count - 1).timestamp;
-    }
-    
-private:
-    Tick m_ticks[MAX_TICKS];
-    int m_count;
-    int m_start;
-};
+#include "tick.h"
+#include "tiered_history.h"
+#include "reorder_buffer.h"
+#include "tick_throttle.h"
+#include "../perf/metrics.h"
+#include "../perf/latency_tracker.h"
 
 // ============================================================================
 // MOCK TICKER - Simulated price data generator
@@ -82,49 +16,179 @@ private:
 class MockTicker
 {
 public:
+    static const int REAGGREGATE_SLICE = 64;   // Candles rebuilt per history query
+    static constexpr double REAGGREGATE_BUDGET_MS = 1.0;   // Default re-aggregation time per update
+    
+    // Fixed-step data clock: one tick per TICK_STEP of simulated time, so the
+    // price path and candle contents depend only on the step count, never on
+    // the render frame rate. Frame time accumulates and is consumed in whole
+    // steps. After throttled or hidden-tab frames at most MAX_STEPS_PER_UPDATE
+    // run per update; the rest stays in the accumulator for later updates.
+    static const int STEPS_PER_SECOND = 60;
+    static constexpr double TICK_STEP = 1.0 / STEPS_PER_SECOND;  // Seconds
+    static const int MAX_STEPS_PER_UPDATE = 600;        // 10 s of data per update
+    static const int CATCHUP_STEPS = 6;                 // Larger updates count as catch-up
+    
     MockTicker();
     
-    // Update the ticker with delta time (call every frame)
-    void update(float deltaTime);
+    // Advance the data clock by delta time (call every frame). Returns the
+    // number of fixed steps (ticks) run, 0 when less than a step accumulated.
+    int update(float deltaTime);
     
     // Getters
-    float getCurrentPrice() const { return m_currentPrice; }
-    float getTicksPerSecond() const { return m_ticksPerSecond; }
+    PriceTicks getCurrentPrice() const { return m_lastPrice; }
+    const PriceScale& getPriceScale() const { return m_priceScale; }
+    float getTicksPerSecond() const { return m_ticksIngested->rate(); }
     float getCandleInterval() const { return m_candleInterval; }
     const Candle& getCurrentCandle() const { return m_currentCandle; }
     const CandleBuffer& getCandleBuffer() const { return m_candleBuffer; }
-    float getElapsedTime() const { return m_elapsedTime; }
+    const TickHistory& getTickHistory() const { return m_history.ticks(); }
+    const TieredHistory& getHistory() const { return m_history; }
+    TimeNs getElapsedTime() const { return stepToNs(m_stepCount); }
+    uint64_t getStepCount() const { return m_stepCount; }
+    double getCatchUpBacklog() const { return m_accumulator; }
+    bool isReaggregating() const { return m_reaggregating; }
+    float getReaggregateProgress() const;   // 0..1, 1 when no re-aggregation is running
     
     // Configuration
     void setVolatility(float v) { m_volatility = v; }
-    
-    // Interval change modes
+    void setTickSize(double tickSize) { m_priceScale = PriceScale(tickSize); }  // Before the first update
+    void setReaggregateBudget(double ms) { m_reaggregateBudgetMs = ms; }        // 0: re-aggregate in one call
+    void configureHistory(HistoryTier tier, const TieredHistory::TierConfig& config) { m_history.configure(tier, config); }
+    void limitHistory(HistoryTier tier, size_t limitBytes) { m_history.setByteLimit(tier, limitBytes); }
+    void setCandleCapacity(int capacity);   // Keeps the newest candles
+    
+    // Out-of-order ticks. Arrivals are sorted within the reorder window
+    // (data clock time) before aggregation, and a candle closes once the
+    // window has passed its end. Ticks later than that are applied as
+    // corrections: into the history tiers, and into the forming or finalized
+    // candle covering their time (high/low, and close when no later tick of
+    // that candle is known; opens stay). Set before the first update.
+    void setReorderWindow(double ms) { m_reorderWindowNs = secondsToNs(ms / 1000.0); }
+    
+    // Simulated feed delay: each tick is stamped up to `ms` before it
+    // arrives, so ticks arrive out of order (0 = in order)
+    void setFeedJitter(double ms) { m_feedJitterNs = secondsToNs(ms / 1000.0); }
+    
+    // Overload policy for ticks on their way into history and candles (see
+    // tick_throttle.h), applied after the reorder window. Ticks held by
+    // conflation are applied first. Window clamped to 1 s.
+    void setTickPolicy(TickPolicy policy, double windowMs);
+    TickPolicy getTickPolicy() const { return m_throttle.getPolicy(); }
+    
+    // Simulated feed rate: ticks per step, stamped evenly across the step
+    // (1 = 60 ticks/s)
+    void setFeedRate(int ticksPerStep) { m_ticksPerStep = ticksPerStep < 1 ? 1 : ticksPerStep; }
+    
+    // Report each applied tick for tick-to-screen latency (optional)
+    void setTickStampSink(TickStampSink* sink) { m_stampSink = sink; }
+    
+    // Hand each generated tick to a recorder, e.g. a journal (optional)
+    void setTickRecorder(TickRecorder* recorder) { m_recorder = recorder; }
+    
+    // Rebuild tick history, candles and price from recorded ticks (journal
+    // recovery), in recorded (arrival) order, before the first update().
+    // Ticks go through the reorder window as if generated; the data clock
+    // advances to the latest one.
+    void replayTicks(const Tick* ticks, int count);
+    
+    // Interval change modes. Preserving history re-aggregates the tiered
+    // history (finest tier covering each range) as a resumable task: the
+    // forming candle is rebuilt at once, so live ticks continue at the new
+    // interval, and older candles newest first, REAGGREGATE_SLICE at a time,
+    // within the re-aggregation budget of each update(). The chart fills in
+    // backwards from the live end. Candles are on a grid anchored at time 0.
     void setCandleInterval(float interval, bool preserveHistory);
     void clearCandles();  // Clear all candles and start fresh
     
+    // Load historical data older than anything resident: candles (at the
+    // current interval, ascending time) open before the forming candle, ticks
+    // before the current data clock time. The forming candle is untouched.
+    // Ticks go into the tiered history (see TieredHistory::backfill) and
+    // make it survive re-aggregation on interval changes.
+    // A running re-aggregation is completed first. Returns the number of
+    // candles prepended.
+    int backfill(const Candle* candles, int candleCount, const Tick* ticks, int tickCount);
+    
 private:
     // Price state
-    float m_currentPrice;
+    float m_walkPrice;          // Continuous random walk value
+    PriceTicks m_lastPrice;     // Walk value on the instrument's price grid
+    PriceScale m_priceScale;
     float m_volatility;
     float m_candleInterval;
     bool m_initialized;
-    float m_elapsedTime;  // Total elapsed time since start
     
-    // Tick history for re-aggregation
-    TickHistory m_tickHistory;
+    // Data clock
+    uint64_t m_stepCount;     // Fixed steps run since start (simulated time base)
+    double m_accumulator;     // Frame time not yet consumed by steps (seconds)
+    
+    // Ticks, 1s and 1m candles for re-aggregation (compacted every update)
+    TieredHistory m_history;
+    
+    // Arrivals not yet released to aggregation (time order)
+    ReorderBuffer m_reorder;
+    TimeNs m_reorderWindowNs;
+    TimeNs m_feedJitterNs;
+    TimeNs m_lastTickTime;      // Newest tick applied (m_lastPrice's time)
+    
+    // Released ticks are conflated or sampled here under an overload policy
+    TickThrottle m_throttle;
+    int m_ticksPerStep;
     
     // Candle aggregation
     CandleBuffer m_candleBuffer;
     Candle m_currentCandle;
-    float m_candleTimer;
-    
-    // Tick rate tracking
-    int m_tickCount;
-    float m_tickRateTimer;
-    float m_ticksPerSecond;
+    uint64_t m_candleStartStep;   // Step at which the forming candle opened
+    
+    // Re-aggregation in progress (walks the history backwards in time)
+    bool m_reaggregating;
+    double m_reaggregateBudgetMs;
+    TimeNs m_reaggregateIntervalNs;
+    TimeNs m_reaggregateBefore;     // Candles before this are still to be built
+    TimeNs m_reaggregateFrom;       // Forming candle start at the switch
+    TimeNs m_reaggregateOldest;     // Oldest history at the switch (progress)
+    std::vector<Candle> m_reaggregateCandles;   // One slice
+    
+    // Latency reporting and tick recording (not owned)
+    TickStampSink* m_stampSink;
+    TickRecorder* m_recorder;
+    
+    // Throughput metrics (owned by MetricsRegistry)
+    Metric* m_ticksIngested;
+    Metric* m_candlesFinalized;
+    Metric* m_reaggregations;
+    Metric* m_reaggregateSlices;
+    Metric* m_candlesBackfilled;
+    Metric* m_ticksBackfilled;
+    Metric* m_candleCount;
+    Metric* m_candleCapacity;
+    Metric* m_catchUpTicks;
+    Metric* m_ticksReordered;
+    Metric* m_lateTicks;
+    Metric* m_candlesCorrected;
+    Metric* m_ticksConflated;
+    Metric* m_ticksDropped;
+    Metric* m_tickPolicy;
+    Metric* m_tickPolicyWindow;
+    Metric* m_catchUpBacklogGauge;
     
     // Helpers
     float randomWalk();
+    void initialize();
+    void step();
+    void ingestTick(const StampedTick& stamped, bool live);
+    void releaseTicks(TimeNs upTo, bool live);
+    void admitTick(const StampedTick& stamped, bool live);
+    void flushConflated(bool live);
+    void emitTick(const StampedTick& stamped, bool live);
+    void applyTick(const Tick& tick);
+    void correctLateTick(const Tick& tick);
+    TimeNs candleEnd() const { return stepToNs(m_candleStartStep + intervalSteps()); }
+    uint64_t intervalSteps() const;
+    static TimeNs stepToNs(uint64_t step) { return (TimeNs)(step * NS_PER_SECOND / STEPS_PER_SECOND); }
+    static uint64_t nsToStep(TimeNs t) { return (uint64_t)((t * STEPS_PER_SECOND + NS_PER_SECOND - 1) / NS_PER_SECOND); }  // Inverse, rounding up
     void finalizeCandle();
     void reaggregateFromHistory(float newInterval);
+    void continueReaggregation(double budgetMs);
 };
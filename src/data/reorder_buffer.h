@@ -0,0 +1,64 @@
+#pragma once
+
+#include "tick.h"
+#include <stdint.h>
+
+// ============================================================================
+// REORDER BUFFER
+// Bounded holding area that puts slightly out-of-order ticks back in time
+// order before aggregation. Ticks are inserted sorted (O(1) when they arrive
+// in order, O(displacement) otherwise) and released oldest first once the
+// data clock has passed them by the lateness window. Releasing moves a
+// watermark: a tick stamped before it arrived too late to be sorted in and
+// is applied as a correction instead (see MockTicker::setReorderWindow).
+// ============================================================================
+
+class ReorderBuffer
+{
+public:
+    static const int DEFAULT_CAPACITY = 1024;   // Ticks held; when full the oldest is released early
+    
+    explicit ReorderBuffer(int capacity = DEFAULT_CAPACITY) : m_ticks(capacity), m_watermark(INT64_MIN) {}
+    
+    int count() const { return m_ticks.count(); }
+    bool full() const { return m_ticks.full(); }
+    TimeNs getWatermark() const { return m_watermark; }
+    
+    // Stamped before the watermark: too late to sort in
+    bool isLate(const Tick& tick) const { return tick.timestamp < m_watermark; }
+    
+    // Sort in a tick that is not late (not when full). Returns false when it
+    // arrived out of order, i.e. before a held tick stamped later.
+    bool insert(const StampedTick& stamped)
+    {
+        int n = m_ticks.count();
+        TimeNs t = stamped.tick.timestamp;
+        if (n == 0 || m_ticks.get(n - 1).tick.timestamp <= t)
+        {
+            m_ticks.push(stamped);
+            return true;
+        }
+        m_ticks.insert(upperBoundTime(m_ticks, t), stamped);
+        return false;
+    }
+    
+    // Oldest held tick, and its release (the watermark moves up to its time)
+    const StampedTick& oldest() const { return m_ticks.get(0); }
+    void popOldest()
+    {
+        if (m_ticks.get(0).tick.timestamp > m_watermark)
+            m_watermark = m_ticks.get(0).tick.timestamp;
+        m_ticks.dropFront(1);
+    }
+    
+    // Ticks stamped before t are final (once every held one was released)
+    void advance(TimeNs t)
+    {
+        if (t > m_watermark)
+            m_watermark = t;
+    }
+    
+private:
+    DynamicRingBuffer<StampedTick> m_ticks;   // With their ingest stamps
+    TimeNs m_watermark;
+};
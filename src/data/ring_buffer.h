@@ -0,0 +1,244 @@
+#pragma once
+
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+// ============================================================================
+// RING BUFFER
+// Fixed-capacity FIFO that overwrites its oldest element when full. Capacity
+// is a power of two so indexing is a mask, not a division. Elements are
+// copied with memcpy (bulk pushes and prepends are at most two copies across
+// the wrap), and contiguous spans are exposed for tight loops and SIMD
+// kernels. Older history can be prepended into free capacity (backfill).
+//
+//   RingBuffer<T, Capacity>   capacity fixed at compile time (inline array)
+//   DynamicRingBuffer<T>      capacity chosen at runtime (heap storage)
+// ============================================================================
+
+template <typename T>
+struct Span
+{
+    const T* data;
+    int count;
+};
+
+// Up to two contiguous spans covering a logical index range of a ring
+template <typename T>
+struct RangeView
+{
+    Span<T> spans[2];   // spans[1].count == 0 unless the range wraps
+    int first;          // Logical index of the first element in the buffer
+    int count;          // Total elements across both spans
+    
+    bool empty() const { return count == 0; }
+};
+
+// Shared implementation; Derived provides storage() and storageMask()
+template <typename T, typename Derived>
+class RingBufferOps
+{
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer elements are copied with memcpy");
+    
+public:
+    int count() const { return m_count; }
+    int capacity() const { return mask() + 1; }
+    bool full() const { return m_count == capacity(); }
+    
+    // Append one element, overwriting the oldest when full
+    void push(const T& item)
+    {
+        if (m_count < capacity())
+        {
+            data()[(m_head + m_count) & mask()] = item;
+            m_count++;
+        }
+        else
+        {
+            data()[m_head] = item;
+            m_head = (m_head + 1) & mask();
+        }
+    }
+    
+    // Append n elements (oldest first); only the newest capacity() are kept
+    void pushBulk(const T* items, int n)
+    {
+        int cap = capacity();
+        if (n <= 0) return;
+        if (n > cap)
+        {
+            items += n - cap;
+            n = cap;
+        }
+        
+        int tail = (m_head + m_count) & mask();
+        int first = cap - tail < n ? cap - tail : n;
+        memcpy(data() + tail, items, sizeof(T) * first);
+        memcpy(data(), items + first, sizeof(T) * (n - first));
+        
+        int total = m_count + n;
+        if (total > cap)
+        {
+            m_head = (m_head + total - cap) & mask();
+            m_count = cap;
+        }
+        else
+        {
+            m_count = total;
+        }
+    }
+    
+    // Insert n elements (oldest first) in front of the oldest element. Never
+    // overwrites: only the newest items that fit in the free capacity are
+    // kept. Returns the number inserted.
+    int prependBulk(const T* items, int n)
+    {
+        int cap = capacity();
+        int space = cap - m_count;
+        if (n > space)
+        {
+            items += n - space;
+            n = space;
+        }
+        if (n <= 0) return 0;
+        
+        int start = (m_head - n) & mask();
+        int first = cap - start < n ? cap - start : n;
+        memcpy(data() + start, items, sizeof(T) * first);
+        memcpy(data(), items + first, sizeof(T) * (n - first));
+        
+        m_head = start;
+        m_count += n;
+        return n;
+    }
+    
+    // Element at logical index (0 = oldest)
+    const T& get(int index) const { return data()[(m_head + index) & mask()]; }
+    T& get(int index) { return data()[(m_head + index) & mask()]; }
+    
+    // Contiguous spans covering logical indices [begin, end)
+    RangeView<T> view(int begin, int end) const
+    {
+        RangeView<T> view = {};
+        view.first = begin;
+        view.count = end > begin ? end - begin : 0;
+        if (view.count == 0)
+            return view;
+        
+        int start = (m_head + begin) & mask();
+        int first = capacity() - start < view.count ? capacity() - start : view.count;
+        view.spans[0].data = data() + start;
+        view.spans[0].count = first;
+        view.spans[1].data = data();
+        view.spans[1].count = view.count - first;
+        return view;
+    }
+    
+    // Contiguous spans covering every element, oldest first
+    RangeView<T> segments() const { return view(0, m_count); }
+    
+    // Insert at a logical index, moving the newer elements up by one. Not
+    // when full; O(count() - index), meant for inserts near the newest end.
+    void insert(int index, const T& item)
+    {
+        m_count++;
+        for (int i = m_count - 1; i > index; i--)
+            get(i) = get(i - 1);
+        get(index) = item;
+    }
+    
+    // Remove the n oldest elements
+    void dropFront(int n)
+    {
+        if (n > m_count) n = m_count;
+        if (n <= 0) return;
+        m_head = (m_head + n) & mask();
+        m_count -= n;
+    }
+    
+    void clear()
+    {
+        m_head = 0;
+        m_count = 0;
+    }
+    
+protected:
+    RingBufferOps() : m_head(0), m_count(0) {}
+    
+    int m_head;     // Physical index of the oldest element
+    int m_count;
+    
+private:
+    T* data() { return static_cast<Derived*>(this)->storage(); }
+    const T* data() const { return static_cast<const Derived*>(this)->storage(); }
+    int mask() const { return static_cast<const Derived*>(this)->storageMask(); }
+};
+
+template <typename T, int Capacity>
+class RingBuffer : public RingBufferOps<T, RingBuffer<T, Capacity>>
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+    
+public:
+    static const int CAPACITY = Capacity;
+    
+private:
+    friend class RingBufferOps<T, RingBuffer<T, Capacity>>;
+    
+    T m_items[Capacity];
+    
+    T* storage() { return m_items; }
+    const T* storage() const { return m_items; }
+    int storageMask() const { return Capacity - 1; }
+};
+
+template <typename T>
+class DynamicRingBuffer : public RingBufferOps<T, DynamicRingBuffer<T>>
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit DynamicRingBuffer(int minCapacity = 1) { reset(minCapacity); }
+    
+    // Change capacity; drops all elements
+    void reset(int minCapacity)
+    {
+        int capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        std::vector<T>(capacity, T()).swap(m_items);     // Releases the old storage
+        m_mask = capacity - 1;
+        this->clear();
+    }
+    
+    // Change capacity keeping the newest elements that fit
+    void resize(int minCapacity)
+    {
+        int capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        if (capacity == this->capacity())
+            return;
+        
+        int keep = this->count() < capacity ? this->count() : capacity;
+        std::vector<T> items(capacity, T());
+        RangeView<T> newest = this->view(this->count() - keep, this->count());
+        if (keep > 0)
+        {
+            memcpy(items.data(), newest.spans[0].data, sizeof(T) * newest.spans[0].count);
+            memcpy(items.data() + newest.spans[0].count, newest.spans[1].data, sizeof(T) * newest.spans[1].count);
+        }
+        
+        m_items.swap(items);
+        m_mask = capacity - 1;
+        this->m_head = 0;
+        this->m_count = keep;
+    }
+    
+private:
+    friend class RingBufferOps<T, DynamicRingBuffer<T>>;
+    
+    std::vector<T> m_items;
+    int m_mask;
+    
+    T* storage() { return m_items.data(); }
+    const T* storage() const { return m_items.data(); }
+    int storageMask() const { return m_mask; }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "market_types.h"
+#include "time_index.h"
+
+// ============================================================================
+// TICK DATA - Raw price data with timestamp
+// ============================================================================
+
+struct Tick
+{
+    TimeNs timestamp;   // Data clock time
+    PriceTicks price;
+    
+    Tick() : timestamp(0), price(0) {}
+    Tick(PriceTicks p, TimeNs t) : timestamp(t), price(p) {}
+};
+
+inline TimeNs timeOf(const Tick& tick) { return tick.timestamp; }
+
+// A tick on its way to the candles, with its ingest stamp beside it for
+// tick-to-screen latency. Only the live path (reorder window, overload
+// policy) carries stamps; stored ticks are plain Ticks.
+struct StampedTick
+{
+    Tick tick;
+    double ingestTime;  // Monotonic clock (ms) when the tick entered the process (0: replayed)
+    
+    StampedTick() : ingestTime(0) {}
+    StampedTick(const Tick& t, double ingest) : tick(t), ingestTime(ingest) {}
+};
+
+inline TimeNs timeOf(const StampedTick& stamped) { return stamped.tick.timestamp; }
+
+// Receives every tick as it is generated (e.g. a durable journal)
+class TickRecorder
+{
+public:
+    virtual ~TickRecorder() {}
+    virtual void record(const Tick& tick) = 0;
+};
+
+// ============================================================================
+// TICK HISTORY - Ring buffer for storing raw tick data
+// Capacity is set at runtime (see TieredHistory's byte budgets)
+// ============================================================================
+
+class TickHistory : public DynamicRingBuffer<Tick>
+{
+public:
+    static const int MAX_TICKS = 65536;     // Default capacity, ~18 minutes at 60 ticks/s
+    
+    TickHistory() : DynamicRingBuffer<Tick>(MAX_TICKS) {}
+    
+    // Ticks in [t0, t1), and the last n at or before t (O(log n), zero-copy)
+    RangeView<Tick> queryRange(TimeNs t0, TimeNs t1) const { return queryTimeRange<Tick>(*this, t0, t1); }
+    RangeView<Tick> queryLast(int n, TimeNs t) const { return queryLastN<Tick>(*this, n, t); }
+    
+    // Prepend older, time-ordered ticks stamped before both the oldest
+    // resident tick and `before`, up to the free capacity. Returns the number
+    // prepended.
+    int backfill(const Tick* ticks, int n, TimeNs before) { return backfillTimeOrdered(*this, ticks, n, before); }
+    
+    // Get earliest timestamp in history
+    TimeNs getStartTime() const
+    {
+        if (count() == 0) return 0;
+        return get(0).timestamp;
+    }
+    
+    // Get latest timestamp in history
+    TimeNs getEndTime() const
+    {
+        if (count() == 0) return 0;
+        return get(count() - 1).timestamp;
+    }
+};
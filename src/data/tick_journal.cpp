@@ -0,0 +1,254 @@
+#include "tick_journal.h"
+#include "../kernels/crc32c.h"
+#include "../platform/platform.h"
+#include <string.h>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+// Ticks handed to the replay callback per call
+static const int REPLAY_BATCH = 4096;
+
+TickJournal::TickJournal()
+    : m_fd(-1)
+    , m_recoveredTicks(0)
+    , m_stopping(false)
+    , m_fileSize(0)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_recordsCommitted = metrics.counter("journal.records");
+    m_commits = metrics.counter("journal.commits");
+    m_bytesWritten = metrics.counter("journal.bytes");
+    m_commitMs = metrics.gauge("journal.commit_ms");
+    m_recovered = metrics.counter("journal.recovered");
+    m_truncatedBytes = metrics.counter("journal.truncated_bytes");
+    m_writeErrors = metrics.counter("journal.write_errors");
+}
+
+TickJournal::~TickJournal()
+{
+    close();
+}
+
+bool TickJournal::open(const char* path, double tickSize, const Config& config, TickReplayFn replay, void* user)
+{
+    close();
+    m_config = config;
+    
+    bool unusable = false;
+    uint64_t validBytes = recover(path, tickSize, replay, user, unusable);
+    if (unusable)
+        return false;
+    
+    m_fd = ::open(path, O_WRONLY | O_CREAT, 0644);
+    if (m_fd < 0)
+        return false;
+    
+    struct stat st;
+    uint64_t size = fstat(m_fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+    if (validBytes == 0)
+    {
+        // New journal
+        JournalHeader header = { JOURNAL_MAGIC, JOURNAL_VERSION, tickSize };
+        if (ftruncate(m_fd, 0) != 0 || pwrite(m_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        {
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        validBytes = sizeof(header);
+    }
+    else if (size > validBytes)
+    {
+        // Drop the torn or corrupt tail so new frames follow valid ones
+        m_truncatedBytes->add((int64_t)(size - validBytes));
+        if (ftruncate(m_fd, validBytes) != 0)
+            m_writeErrors->add();
+    }
+    
+    m_fileSize = validBytes;
+    m_stopping = false;
+    m_writer = std::thread(&TickJournal::writerMain, this);
+    return true;
+}
+
+void TickJournal::close()
+{
+    if (m_fd < 0)
+        return;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_writer.join();
+    
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+void TickJournal::record(const Tick& tick)
+{
+    JournalRecord record = { tick.timestamp, tick.price, 0 };
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(record);
+        full = (int)m_pending.size() == m_config.batchTicks;
+    }
+    if (full)
+        m_wake.notify_one();
+}
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+
+uint64_t TickJournal::recover(const char* path, double tickSize, TickReplayFn replay, void* user, bool& unusable)
+{
+    m_recoveredTicks = 0;
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    
+    // Empty: a new journal. Shorter than a header (or not readable): not
+    // one of ours.
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        unusable = true;
+        ::close(fd);
+        return 0;
+    }
+    if (st.st_size < (off_t)sizeof(JournalHeader))
+    {
+        unusable = st.st_size != 0;
+        ::close(fd);
+        return 0;
+    }
+    
+    uint64_t size = (uint64_t)st.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        unusable = true;
+        return 0;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    const unsigned char* data = (const unsigned char*)mapping;
+    
+    // Never overwrite a file that is not a journal of this instrument
+    JournalHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION || header.tickSize != tickSize)
+    {
+        munmap(mapping, size);
+        unusable = true;
+        return 0;
+    }
+    
+    // Frames up to the first torn or corrupt one
+    std::vector<Tick> ticks(REPLAY_BATCH);
+    int pending = 0;
+    uint64_t offset = sizeof(header);
+    while (size - offset >= sizeof(JournalFrame))
+    {
+        JournalFrame frame;
+        memcpy(&frame, data + offset, sizeof(frame));
+        uint64_t bytes = (uint64_t)frame.count * sizeof(JournalRecord);
+        if (frame.magic != JOURNAL_FRAME_MAGIC || bytes > size - offset - sizeof(frame))
+            break;
+        
+        const unsigned char* payload = data + offset + sizeof(frame);
+        if (crc32c(payload, bytes) != frame.crc)
+            break;
+        
+        const JournalRecord* records = (const JournalRecord*)payload;
+        for (uint32_t i = 0; i < frame.count; i++)
+        {
+            ticks[pending++] = Tick(records[i].price, records[i].timestamp);
+            if (pending == REPLAY_BATCH)
+            {
+                replay(user, ticks.data(), pending);
+                pending = 0;
+            }
+        }
+        
+        m_recoveredTicks += frame.count;
+        offset += sizeof(frame) + bytes;
+    }
+    if (pending > 0)
+        replay(user, ticks.data(), pending);
+    
+    munmap(mapping, size);
+    m_recovered->add(m_recoveredTicks);
+    return offset;
+}
+
+// ============================================================================
+// GROUP COMMIT
+// ============================================================================
+
+void TickJournal::writerMain()
+{
+    std::vector<JournalRecord> batch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_config.flushIntervalMs), [this]()
+        {
+            return m_stopping || (int)m_pending.size() >= m_config.batchTicks;
+        });
+        
+        // Take everything queued; the producer keeps appending meanwhile
+        batch.swap(m_pending);
+        bool stopping = m_stopping && batch.empty();
+        lock.unlock();
+        
+        if (stopping)
+            return;
+        if (!batch.empty())
+            commit(batch);
+        batch.clear();
+        
+        lock.lock();
+    }
+}
+
+void TickJournal::commit(std::vector<JournalRecord>& records)
+{
+    double start = platformNowMs();
+    size_t payloadBytes = records.size() * sizeof(JournalRecord);
+    JournalFrame frame = { JOURNAL_FRAME_MAGIC, (uint32_t)records.size(), crc32c(records.data(), payloadBytes), 0 };
+    
+    // Frame header and records in one write
+    struct iovec parts[2];
+    parts[0].iov_base = &frame;
+    parts[0].iov_len = sizeof(frame);
+    parts[1].iov_base = records.data();
+    parts[1].iov_len = payloadBytes;
+    
+    ssize_t expected = (ssize_t)(sizeof(frame) + payloadBytes);
+    bool written = pwritev(m_fd, parts, 2, (off_t)m_fileSize) == expected;
+    
+    // With sync on, a group only counts as committed once it is durable
+    if (!written || (m_config.sync && fdatasync(m_fd) != 0))
+    {
+        // Keep the file ending on a complete frame; these records are lost
+        m_writeErrors->add();
+        if (ftruncate(m_fd, (off_t)m_fileSize) != 0)
+            m_writeErrors->add();
+        return;
+    }
+    
+    m_fileSize += expected;
+    m_recordsCommitted->add((int64_t)records.size());
+    m_commits->add();
+    m_bytesWritten->add(expected);
+    m_commitMs->set(platformNowMs() - start);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "tick.h"
+#include "../perf/metrics.h"
+#include <stdint.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// ============================================================================
+// TICK JOURNAL (native only)
+// Append-only file of every ingested tick, so a restarted instance can
+// rebuild its tick history and candles. Layout:
+//
+//   JournalHeader                          magic, version, tick size
+//   frame: JournalFrame + records[count]   one frame per group commit
+//
+// Records are appended to memory by the producer; a writer thread commits
+// them as one CRC-32C framed write (plus fdatasync) per flush interval or
+// once a batch fills, so ticks reach the disk in batches, never one by one.
+// Recovery memory-maps the file and replays frames until the first torn or
+// corrupt one, which is truncated away before appending resumes.
+// ============================================================================
+
+static const uint32_t JOURNAL_MAGIC = 0x314E4A54;       // "TJN1"
+static const uint32_t JOURNAL_FRAME_MAGIC = 0x31464A54; // "TJF1"
+static const uint32_t JOURNAL_VERSION = 1;
+
+struct JournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    double tickSize;
+};
+
+struct JournalFrame
+{
+    uint32_t magic;
+    uint32_t count;         // Records following the frame header
+    uint32_t crc;           // CRC-32C of the records
+    uint32_t reserved;
+};
+
+struct JournalRecord
+{
+    TimeNs timestamp;
+    PriceTicks price;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(JournalHeader) == 16 && sizeof(JournalFrame) == 16 && sizeof(JournalRecord) == 16,
+              "Journal layout is fixed on disk");
+
+// Receives recovered ticks in time order, a batch at a time
+typedef void (*TickReplayFn)(void* user, const Tick* ticks, int count);
+
+class TickJournal : public TickRecorder
+{
+public:
+    struct Config
+    {
+        int flushIntervalMs;    // Longest a tick waits before its commit
+        int batchTicks;         // Commit early once this many are pending
+        bool sync;              // fdatasync each commit (durable, not just written)
+        
+        Config() : flushIntervalMs(50), batchTicks(4096), sync(true) {}
+    };
+    
+    TickJournal();
+    ~TickJournal();
+    
+    // Replay the valid prefix of an existing journal (none: nothing to do),
+    // then open it for appending and start the writer thread. Returns false
+    // when the file cannot be opened or was written with another tick size.
+    bool open(const char* path, double tickSize, const Config& config, TickReplayFn replay, void* user);
+    
+    // Commit everything pending and stop the writer
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+    
+    // Producer thread: queue a tick for the next commit
+    void record(const Tick& tick) override;
+    
+    int64_t getRecoveredTicks() const { return m_recoveredTicks; }
+    
+private:
+    int m_fd;
+    Config m_config;
+    int64_t m_recoveredTicks;
+    
+    // Records queued by the producer, swapped out by the writer per commit
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<JournalRecord> m_pending;
+    bool m_stopping;
+    std::thread m_writer;
+    uint64_t m_fileSize;    // Writer-only: end of the last complete frame
+    
+    Metric* m_recordsCommitted;
+    Metric* m_commits;
+    Metric* m_bytesWritten;
+    Metric* m_commitMs;
+    Metric* m_recovered;
+    Metric* m_truncatedBytes;
+    Metric* m_writeErrors;
+    
+    uint64_t recover(const char* path, double tickSize, TickReplayFn replay, void* user, bool& unusable);
+    void writerMain();
+    void commit(std::vector<JournalRecord>& records);
+};
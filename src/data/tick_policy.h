@@ -0,0 +1,25 @@
+#pragma once
+
+// ============================================================================
+// TICK POLICY
+// Overload policies for ticks (see tick_throttle.h) and their names. The
+// policy is published as the ticks.policy gauge, so readers of metrics
+// (the perf panel) use this header without the throttle.
+// ============================================================================
+
+enum TickPolicy
+{
+    TICK_KEEP_ALL,
+    TICK_CONFLATE,
+    TICK_SAMPLE,
+    TICK_POLICY_COUNT
+};
+
+static const char* const TICK_POLICY_NAMES[] = { "keep all", "conflate", "sample" };
+static_assert(sizeof(TICK_POLICY_NAMES) / sizeof(TICK_POLICY_NAMES[0]) == TICK_POLICY_COUNT, "One name per tick policy");
+
+// Name of a policy, or of a gauge value ("?" when out of range)
+inline const char* tickPolicyName(int policy)
+{
+    return policy >= 0 && policy < TICK_POLICY_COUNT ? TICK_POLICY_NAMES[policy] : "?";
+}
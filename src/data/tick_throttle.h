@@ -0,0 +1,118 @@
+#pragma once
+
+#include "tick.h"
+#include "tick_policy.h"
+#include <stdint.h>
+
+// ============================================================================
+// TICK THROTTLE
+// Overload policy for ticks on their way (in time order) into history and
+// candle aggregation:
+//
+//   TICK_KEEP_ALL   every tick is applied
+//   TICK_CONFLATE   per window, the first tick passes and the rest are held
+//                   and applied as their high, low and last (at most 3)
+//   TICK_SAMPLE     per window, the first tick passes and the rest are dropped
+//
+// Windows are cut on a grid restarted every second, so none spans a second
+// (or 1s candle) boundary; the caller also closes a window where a candle
+// ends. Conflation keeps every candle's open, high, low and close exact,
+// live and re-aggregated from history. Sampling does not (high/low are
+// lost), it bounds the work per window most tightly.
+// ============================================================================
+
+class TickThrottle
+{
+public:
+    static const int MAX_FLUSH = 3;     // Ticks a conflated window is applied as
+    
+    TickThrottle()
+        : m_policy(TICK_KEEP_ALL), m_windowNs(NS_PER_SECOND), m_windowEnd(INT64_MIN), m_firstPrice(0)
+        , m_held(0), m_highSeq(0), m_lowSeq(0)
+    {}
+    
+    // Window length, clamped to 1 ns .. 1 s. Drop held ticks (flush()
+    // first) and start over with the next tick.
+    void setPolicy(TickPolicy policy, TimeNs windowNs)
+    {
+        m_policy = policy;
+        m_windowNs = windowNs < 1 ? 1 : windowNs > NS_PER_SECOND ? NS_PER_SECOND : windowNs;
+        m_windowEnd = INT64_MIN;
+        m_held = 0;
+    }
+    TickPolicy getPolicy() const { return m_policy; }
+    TimeNs getWindow() const { return m_windowNs; }
+    
+    // Whether a tick falls in the open window (time order: not before it)
+    bool inWindow(const Tick& tick) const { return tick.timestamp < m_windowEnd; }
+    
+    // Open the window of a tick that passes (the window's first)
+    void open(const Tick& tick)
+    {
+        TimeNs second = floorToInterval(tick.timestamp, NS_PER_SECOND);
+        m_windowEnd = second + ((tick.timestamp - second) / m_windowNs + 1) * m_windowNs;
+        if (m_windowEnd > second + NS_PER_SECOND)
+            m_windowEnd = second + NS_PER_SECOND;
+        m_firstPrice = tick.price;
+        m_held = 0;
+    }
+    TimeNs windowEnd() const { return m_windowEnd; }
+    
+    // Conflate a tick into the open window
+    void hold(const StampedTick& stamped)
+    {
+        m_held++;
+        if (m_held == 1 || stamped.tick.price > m_high.tick.price)
+        {
+            m_high = stamped;
+            m_highSeq = m_held;
+        }
+        if (m_held == 1 || stamped.tick.price < m_low.tick.price)
+        {
+            m_low = stamped;
+            m_lowSeq = m_held;
+        }
+        m_last = stamped;
+    }
+    int heldCount() const { return m_held; }
+    
+    // Ticks summarizing the held ones, in time order without repeats: the
+    // high and low when beyond the window's first price, then the last.
+    // Returns the count (0 when nothing is held); the window stays open.
+    int flush(StampedTick out[MAX_FLUSH])
+    {
+        if (m_held == 0)
+            return 0;
+        
+        int n = 0;
+        bool high = m_high.tick.price > m_firstPrice && m_highSeq != m_held;
+        bool low = m_low.tick.price < m_firstPrice && m_lowSeq != m_held;
+        if (high && low && m_lowSeq < m_highSeq)
+        {
+            out[n++] = m_low;
+            out[n++] = m_high;
+        }
+        else
+        {
+            if (high) out[n++] = m_high;
+            if (low) out[n++] = m_low;
+        }
+        out[n++] = m_last;
+        m_held = 0;
+        return n;
+    }
+    
+private:
+    TickPolicy m_policy;
+    TimeNs m_windowNs;
+    TimeNs m_windowEnd;     // INT64_MIN: no window open
+    PriceTicks m_firstPrice;
+    
+    // Held ticks (conflation): count, extremes with their order, last
+    int m_held;
+    StampedTick m_high;
+    StampedTick m_low;
+    StampedTick m_last;
+    int m_highSeq;
+    int m_lowSeq;
+};
@@ -0,0 +1,498 @@
+#include "tiered_history.h"
+#include "../kernels/price_kernels.h"
+
+// Ticks bucketed per kernel call
+static const int BUCKET_BLOCK = 256;
+
+const TimeNs TieredHistory::RESOLUTION_NS[TIER_COUNT] = { 0, NS_PER_SECOND, 60 * NS_PER_SECOND };
+
+const TieredHistory::TierConfig TieredHistory::DEFAULT_CONFIG[TIER_COUNT] =
+{
+    { 15 * 60 * NS_PER_SECOND, TickHistory::MAX_TICKS * sizeof(Tick) },    // 1 MB, ~18 minutes at 60 ticks/s
+    { 6 * 3600 * NS_PER_SECOND, 1 << 20 },                                  // 32768 candles, ~9 hours
+    { 30 * 86400 * NS_PER_SECOND, 2 << 20 }                                 // 65536 candles, ~45 days
+};
+
+const char* const TieredHistory::TIER_NAMES[TIER_COUNT] = { "ticks", "1s", "1m" };
+
+// First of n time-ordered items at or after t
+template <typename T>
+static int firstAtOrAfter(const T* items, int n, TimeNs t)
+{
+    int lo = 0;
+    int hi = n;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (timeOf(items[mid]) < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Fold one price bar into the candles appended since `first`: same bucket
+// as the newest extends it, otherwise it opens a new candle
+static void mergeBar(std::vector<Candle>& out, size_t first, TimeNs bucket,
+                     PriceTicks open, PriceTicks high, PriceTicks low, PriceTicks close)
+{
+    if (out.size() > first && out.back().time == bucket)
+    {
+        Candle& candle = out.back();
+        if (high > candle.high) candle.high = high;
+        if (low < candle.low) candle.low = low;
+        candle.close = close;
+    }
+    else
+    {
+        out.push_back(Candle(bucket, open, high, low, close));
+    }
+}
+
+TieredHistory::TieredHistory()
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_compacted = metrics.counter("history.compacted");
+    m_dropped = metrics.counter("history.dropped");
+    m_tierBytes[TIER_TICKS] = metrics.gauge("history.tick_bytes");
+    m_tierBytes[TIER_SECONDS] = metrics.gauge("history.second_bytes");
+    m_tierBytes[TIER_MINUTES] = metrics.gauge("history.minute_bytes");
+    
+    for (int t = 0; t < TIER_COUNT; t++)
+    {
+        m_config[t] = DEFAULT_CONFIG[t];
+        m_byteLimit[t] = SIZE_MAX;
+    }
+    m_ticks.reset(capacityFor(TIER_TICKS, m_config[TIER_TICKS].budgetBytes));
+    for (int t = TIER_SECONDS; t < TIER_COUNT; t++)
+        m_candles[t].reset(capacityFor((HistoryTier)t, m_config[t].budgetBytes));
+    updateGauges();
+}
+
+int TieredHistory::capacityFor(HistoryTier tier, size_t budgetBytes)
+{
+    size_t records = budgetBytes / (tier == TIER_TICKS ? sizeof(Tick) : sizeof(Candle));
+    int capacity = 1;
+    while ((size_t)capacity * 2 <= records && capacity < (1 << 30))
+        capacity <<= 1;
+    return capacity;
+}
+
+void TieredHistory::configure(HistoryTier tier, const TierConfig& config)
+{
+    m_config[tier] = config;
+    applyCapacity(tier);
+}
+
+void TieredHistory::setByteLimit(HistoryTier tier, size_t limitBytes)
+{
+    m_byteLimit[tier] = limitBytes;
+    applyCapacity(tier);
+}
+
+void TieredHistory::applyCapacity(HistoryTier tier)
+{
+    size_t budget = m_config[tier].budgetBytes < m_byteLimit[tier] ? m_config[tier].budgetBytes : m_byteLimit[tier];
+    int capacity = capacityFor(tier, budget);
+    if (capacity == this->capacity(tier))
+        return;
+    
+    fit(tier, capacity);
+    if (tier == TIER_TICKS)
+        m_ticks.resize(capacity);
+    else
+        m_candles[tier].resize(capacity);
+    updateGauges();
+}
+
+int TieredHistory::count(HistoryTier tier) const
+{
+    return tier == TIER_TICKS ? m_ticks.count() : m_candles[tier].count();
+}
+
+int TieredHistory::capacity(HistoryTier tier) const
+{
+    return tier == TIER_TICKS ? m_ticks.capacity() : m_candles[tier].capacity();
+}
+
+size_t TieredHistory::usedBytes(HistoryTier tier) const
+{
+    return (size_t)count(tier) * (tier == TIER_TICKS ? sizeof(Tick) : sizeof(Candle));
+}
+
+size_t TieredHistory::reservedBytes(HistoryTier tier) const
+{
+    return (size_t)capacity(tier) * (tier == TIER_TICKS ? sizeof(Tick) : sizeof(Candle));
+}
+
+TimeNs TieredHistory::startTime(HistoryTier tier) const
+{
+    return tier == TIER_TICKS ? m_ticks.get(0).timestamp : m_candles[tier].get(0).time;
+}
+
+void TieredHistory::append(const Tick& tick)
+{
+    // Full: compact the oldest eighth early rather than overwrite it
+    if (m_ticks.full())
+        fit(TIER_TICKS, m_ticks.capacity() - m_ticks.capacity() / 8);
+    m_ticks.push(tick);
+}
+
+bool TieredHistory::insertLate(const Tick& tick)
+{
+    // Making room in a full tier may move the tick's time down a tier
+    if (m_ticks.full() && tick.timestamp >= m_ticks.get(0).timestamp)
+        fit(TIER_TICKS, m_ticks.capacity() - m_ticks.capacity() / 8);
+    if (m_ticks.count() > 0 && tick.timestamp >= m_ticks.get(0).timestamp)
+    {
+        m_ticks.insert(upperBoundTime(m_ticks, tick.timestamp), tick);
+        return true;
+    }
+    
+    for (int t = TIER_SECONDS; t < TIER_COUNT; t++)
+    {
+        CandleHistory& candles = m_candles[t];
+        TimeNs bucket = floorToInterval(tick.timestamp, RESOLUTION_NS[t]);
+        int index = lowerBoundTime(candles, bucket);
+        if (index < candles.count() && candles.get(index).time == bucket)
+        {
+            Candle& candle = candles.get(index);
+            if (tick.price > candle.high) candle.high = tick.price;
+            if (tick.price < candle.low) candle.low = tick.price;
+            return true;
+        }
+        
+        if (candles.full() && index > 0)
+        {
+            fit((HistoryTier)t, candles.capacity() - candles.capacity() / 8);
+            index = lowerBoundTime(candles, bucket);
+        }
+        // Older than the tier's first candle: a coarser tier covers it
+        if (index > 0)
+        {
+            candles.insert(index, Candle(bucket, tick.price, tick.price, tick.price, tick.price));
+            return true;
+        }
+    }
+    
+    // Nothing resident: the tick starts the tick tier
+    if (m_ticks.count() == 0 && count(TIER_SECONDS) == 0 && count(TIER_MINUTES) == 0)
+    {
+        m_ticks.push(tick);
+        return true;
+    }
+    m_dropped->add();
+    return false;
+}
+
+void TieredHistory::compact(TimeNs now)
+{
+    for (int t = TIER_TICKS; t < TIER_MINUTES; t++)
+    {
+        TimeNs next = RESOLUTION_NS[t + 1];
+        moveOlderThan((HistoryTier)t, floorToInterval(now - m_config[t].windowNs, next));
+    }
+    
+    CandleHistory& minutes = m_candles[TIER_MINUTES];
+    int expired = lowerBoundTime(minutes, now - m_config[TIER_MINUTES].windowNs);
+    minutes.dropFront(expired);
+    m_dropped->add(expired);
+    updateGauges();
+}
+
+// Aggregate everything in the tier before `cut` (on the next tier's grid)
+// into the next tier
+void TieredHistory::moveOlderThan(HistoryTier tier, TimeNs cut)
+{
+    HistoryTier next = (HistoryTier)(tier + 1);
+    std::vector<Candle>& moved = m_scratch[next];
+    moved.clear();
+    
+    int n;
+    if (tier == TIER_TICKS)
+    {
+        n = lowerBoundTime(m_ticks, cut);
+        RangeView<Tick> older = m_ticks.view(0, n);
+        for (int s = 0; s < 2; s++)
+            aggregateTicks(older.spans[s].data, older.spans[s].count, RESOLUTION_NS[next], moved, 0);
+        m_ticks.dropFront(n);
+    }
+    else
+    {
+        n = lowerBoundTime(m_candles[tier], cut);
+        RangeView<Candle> older = m_candles[tier].view(0, n);
+        for (int s = 0; s < 2; s++)
+            aggregateCandles(older.spans[s].data, older.spans[s].count, RESOLUTION_NS[next], moved, 0);
+        m_candles[tier].dropFront(n);
+    }
+    if (n == 0)
+        return;
+    
+    m_compacted->add(n);
+    pushCandles(next, moved.data(), (int)moved.size());
+}
+
+// Make the tier hold at most `capacity` records by moving (ticks, 1s) or
+// dropping (1m) the oldest
+void TieredHistory::fit(HistoryTier tier, int capacity)
+{
+    if (capacity < 0) capacity = 0;
+    int excess = count(tier) - capacity;
+    if (excess <= 0)
+        return;
+    
+    if (tier == TIER_MINUTES)
+    {
+        m_candles[tier].dropFront(excess);
+        m_dropped->add(excess);
+        return;
+    }
+    
+    // Whole next-tier buckets move, up to the one holding the last excess record
+    TimeNs next = RESOLUTION_NS[tier + 1];
+    TimeNs last = tier == TIER_TICKS ? m_ticks.get(excess - 1).timestamp : m_candles[tier].get(excess - 1).time;
+    moveOlderThan(tier, floorToInterval(last, next) + next);
+}
+
+// Append candles newer than everything in the tier. The oldest may share
+// the newest resident candle's bucket (the rest of a bucket split across
+// tiers) and is merged into it.
+void TieredHistory::pushCandles(HistoryTier tier, const Candle* candles, int n)
+{
+    CandleHistory& history = m_candles[tier];
+    if (n > 0 && history.count() > 0 && candles[0].time == history.get(history.count() - 1).time)
+    {
+        Candle& newest = history.get(history.count() - 1);
+        if (candles[0].high > newest.high) newest.high = candles[0].high;
+        if (candles[0].low < newest.low) newest.low = candles[0].low;
+        newest.close = candles[0].close;
+        candles++;
+        n--;
+    }
+    
+    // More than the tier holds: everything resident and the oldest
+    // incoming candles (whole next-tier buckets) move on
+    if (n > history.capacity() && tier == TIER_MINUTES)
+    {
+        m_dropped->add(n - history.capacity());
+        candles += n - history.capacity();
+        n = history.capacity();
+    }
+    else if (n > history.capacity())
+    {
+        HistoryTier next = (HistoryTier)(tier + 1);
+        fit(tier, 0);
+        TimeNs boundary = floorToInterval(candles[n - history.capacity() - 1].time, RESOLUTION_NS[next]) + RESOLUTION_NS[next];
+        int split = firstAtOrAfter(candles, n, boundary);
+        
+        std::vector<Candle>& older = m_scratch[next];
+        older.clear();
+        aggregateCandles(candles, split, RESOLUTION_NS[next], older, 0);
+        m_compacted->add(split);
+        pushCandles(next, older.data(), (int)older.size());
+        candles += split;
+        n -= split;
+    }
+    fit(tier, history.capacity() - n);
+    history.pushBulk(candles, n);
+}
+
+// Prepend candles older than everything in this and finer tiers (coarser
+// tiers are empty); what does not fit moves down a tier. The newest may
+// share the oldest resident candle's bucket and is merged into it.
+int TieredHistory::prependCandles(HistoryTier tier, const Candle* candles, int n)
+{
+    CandleHistory& history = m_candles[tier];
+    int merged = 0;
+    if (n > 0 && history.count() > 0 && candles[n - 1].time == history.get(0).time)
+    {
+        const Candle& older = candles[n - 1];
+        Candle& oldest = history.get(0);
+        oldest.open = older.open;
+        if (older.high > oldest.high) oldest.high = older.high;
+        if (older.low < oldest.low) oldest.low = older.low;
+        n--;
+        merged = 1;
+    }
+    
+    int space = history.capacity() - history.count();
+    if (n <= space)
+        return merged + history.prependBulk(candles, n);
+    
+    if (tier == TIER_MINUTES)
+    {
+        m_dropped->add(n - space);
+        return merged + history.prependBulk(candles + n - space, space);
+    }
+    
+    // Split on the next tier's grid so no bucket straddles the tiers
+    HistoryTier next = (HistoryTier)(tier + 1);
+    TimeNs boundary = floorToInterval(candles[n - space - 1].time, RESOLUTION_NS[next]) + RESOLUTION_NS[next];
+    int split = firstAtOrAfter(candles, n, boundary);
+    
+    std::vector<Candle>& older = m_scratch[next];
+    older.clear();
+    aggregateCandles(candles, split, RESOLUTION_NS[next], older, 0);
+    prependCandles(next, older.data(), (int)older.size());
+    return merged + split + history.prependBulk(candles + split, n - split);
+}
+
+int TieredHistory::backfill(const Tick* ticks, int n, TimeNs before)
+{
+    // Coarsest tier holding data: everything backfilled is older
+    int front = TIER_TICKS;
+    for (int t = TIER_MINUTES; t > TIER_TICKS; t--)
+    {
+        if (count((HistoryTier)t) > 0)
+        {
+            front = t;
+            break;
+        }
+    }
+    // Ticks within the oldest candle's bucket are merged into it
+    if (count((HistoryTier)front) > 0)
+    {
+        TimeNs oldest = startTime((HistoryTier)front) + RESOLUTION_NS[front];
+        if (oldest < before)
+            before = oldest;
+    }
+    
+    // Drop ticks at or after the cutoff and anything before an ordering break
+    int end = n;
+    while (end > 0 && ticks[end - 1].timestamp >= before)
+        end--;
+    int begin = 0;
+    for (int i = end - 1; i > 0; i--)
+    {
+        if (ticks[i - 1].timestamp > ticks[i].timestamp)
+        {
+            begin = i;
+            break;
+        }
+    }
+    ticks += begin;
+    n = end - begin;
+    if (n <= 0)
+        return 0;
+    
+    if (front != TIER_TICKS)
+    {
+        std::vector<Candle>& candles = m_scratch[front];
+        candles.clear();
+        aggregateTicks(ticks, n, RESOLUTION_NS[front], candles, 0);
+        prependCandles((HistoryTier)front, candles.data(), (int)candles.size());
+    }
+    else
+    {
+        int space = m_ticks.capacity() - m_ticks.count();
+        int split = 0;
+        if (n > space)
+        {
+            TimeNs boundary = floorToInterval(ticks[n - space - 1].timestamp, NS_PER_SECOND) + NS_PER_SECOND;
+            split = firstAtOrAfter(ticks, n, boundary);
+            
+            std::vector<Candle>& older = m_scratch[TIER_SECONDS];
+            older.clear();
+            aggregateTicks(ticks, split, NS_PER_SECOND, older, 0);
+            prependCandles(TIER_SECONDS, older.data(), (int)older.size());
+        }
+        m_ticks.prependBulk(ticks + split, n - split);
+    }
+    updateGauges();
+    return n;
+}
+
+void TieredHistory::clear()
+{
+    m_ticks.clear();
+    for (int t = TIER_SECONDS; t < TIER_COUNT; t++)
+        m_candles[t].clear();
+    updateGauges();
+}
+
+bool TieredHistory::getTimeRange(TimeNs intervalNs, TimeNs& oldest, TimeNs& newest) const
+{
+    bool found = false;
+    for (int t = TIER_TICKS; t < TIER_COUNT && serves((HistoryTier)t, intervalNs); t++)
+    {
+        int n = count((HistoryTier)t);
+        if (n == 0)
+            continue;
+        
+        oldest = startTime((HistoryTier)t);
+        if (!found)
+            newest = t == TIER_TICKS ? m_ticks.get(n - 1).timestamp : m_candles[t].get(n - 1).time;
+        found = true;
+    }
+    return found;
+}
+
+int TieredHistory::aggregate(TimeNs t0, TimeNs t1, TimeNs intervalNs, std::vector<Candle>& out) const
+{
+    // Each tier serves from t0 up to where the next finer tier's data starts
+    TimeNs to[TIER_COUNT];
+    int coarsest = TIER_TICKS;
+    TimeNs limit = t1;
+    for (int t = TIER_TICKS; t < TIER_COUNT && serves((HistoryTier)t, intervalNs); t++)
+    {
+        to[t] = limit;
+        coarsest = t;
+        if (count((HistoryTier)t) > 0 && startTime((HistoryTier)t) < limit)
+            limit = startTime((HistoryTier)t);
+        if (limit <= t0)
+            break;
+    }
+    
+    size_t first = out.size();
+    for (int t = coarsest; t >= TIER_TICKS; t--)
+    {
+        if (to[t] <= t0)
+            continue;
+        
+        if (t == TIER_TICKS)
+        {
+            RangeView<Tick> range = m_ticks.queryRange(t0, to[t]);
+            for (int s = 0; s < 2; s++)
+                aggregateTicks(range.spans[s].data, range.spans[s].count, intervalNs, out, first);
+        }
+        else
+        {
+            RangeView<Candle> range = m_candles[t].queryRange(t0, to[t]);
+            for (int s = 0; s < 2; s++)
+                aggregateCandles(range.spans[s].data, range.spans[s].count, intervalNs, out, first);
+        }
+    }
+    return (int)(out.size() - first);
+}
+
+void TieredHistory::aggregateTicks(const Tick* ticks, int n, TimeNs intervalNs, std::vector<Candle>& out, size_t first)
+{
+    int buckets[BUCKET_BLOCK];
+    for (int i = 0; i < n; i += BUCKET_BLOCK)
+    {
+        int block = n - i < BUCKET_BLOCK ? n - i : BUCKET_BLOCK;
+        TimeNs start = floorToInterval(ticks[i].timestamp, intervalNs);
+        bucketTicks(ticks + i, block, start, intervalNs, buckets);
+        for (int j = 0; j < block; j++)
+        {
+            PriceTicks price = ticks[i + j].price;
+            mergeBar(out, first, start + buckets[j] * intervalNs, price, price, price, price);
+        }
+    }
+}
+
+void TieredHistory::aggregateCandles(const Candle* candles, int n, TimeNs intervalNs, std::vector<Candle>& out, size_t first)
+{
+    for (int i = 0; i < n; i++)
+    {
+        const Candle& c = candles[i];
+        mergeBar(out, first, floorToInterval(c.time, intervalNs), c.open, c.high, c.low, c.close);
+    }
+}
+
+void TieredHistory::updateGauges()
+{
+    for (int t = 0; t < TIER_COUNT; t++)
+        m_tierBytes[t]->set((double)usedBytes((HistoryTier)t));
+}
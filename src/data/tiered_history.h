@@ -0,0 +1,138 @@
+#pragma once
+
+#include "tick.h"
+#include "../chart/candle.h"
+#include "../perf/metrics.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// TIERED HISTORY
+// Price history kept at decreasing granularity as it ages:
+//
+//   TIER_TICKS     raw ticks              recent window (default 15 minutes)
+//   TIER_SECONDS   1s candles             default 6 hours
+//   TIER_MINUTES   1m candles             default 30 days
+//
+// Each tier is a ring buffer with an age window and a byte budget (which
+// sets its capacity). compact() moves data older than a tier's window into
+// the next coarser tier, aggregated to that tier's resolution. A tier
+// reaching its byte budget compacts early instead of overwriting, so only
+// the minutes tier ever drops data. Tier boundaries are cut on the coarser
+// tier's grid, so every 1s/1m candle is complete and the tiers cover
+// consecutive time ranges, newest in the finest tier.
+//
+// aggregate() builds candles for a time range from the finest tier that
+// still covers each part of it. Candles sit on a grid anchored at time 0,
+// and a tier serves an interval only when the interval is a multiple of its
+// resolution (30s candles come from ticks and 1s candles, never from 1m).
+// ============================================================================
+
+enum HistoryTier
+{
+    TIER_TICKS,
+    TIER_SECONDS,
+    TIER_MINUTES,
+    TIER_COUNT
+};
+
+// Runtime-capacity candle ring with time queries (tiers above ticks)
+class CandleHistory : public DynamicRingBuffer<Candle>
+{
+public:
+    explicit CandleHistory(int minCapacity = 1) : DynamicRingBuffer<Candle>(minCapacity) {}
+    
+    RangeView<Candle> queryRange(TimeNs t0, TimeNs t1) const { return queryTimeRange<Candle>(*this, t0, t1); }
+};
+
+class TieredHistory
+{
+public:
+    struct TierConfig
+    {
+        TimeNs windowNs;        // Data older than this (from now) moves to the next tier
+        size_t budgetBytes;     // Ring capacity: the largest power of two that fits
+    };
+    
+    static const TimeNs RESOLUTION_NS[TIER_COUNT];     // 0 (raw), 1s, 1m
+    static const TierConfig DEFAULT_CONFIG[TIER_COUNT];
+    static const char* const TIER_NAMES[TIER_COUNT];
+    
+    TieredHistory();
+    
+    // Change a tier's window and budget. Shrinking compacts the oldest data
+    // that no longer fits into the next tier first.
+    void configure(HistoryTier tier, const TierConfig& config);
+    const TierConfig& getConfig(HistoryTier tier) const { return m_config[tier]; }
+    
+    // Cap a tier below its configured budget (memory budget governor);
+    // SIZE_MAX lifts the cap. Shrinking compacts like configure().
+    void setByteLimit(HistoryTier tier, size_t limitBytes);
+    
+    // Newest tick (time order)
+    void append(const Tick& tick);
+    
+    // A tick older than ticks already appended (arrived late): sorted into
+    // the tick tier, or folded into the 1s/1m candle covering its time
+    // (opening one when its bucket had no data). Returns false when it is
+    // older than every tier (dropped).
+    bool insertLate(const Tick& tick);
+    
+    // Move data older than each tier's window (relative to now) down a tier.
+    // Incremental: cheap when called every update.
+    void compact(TimeNs now);
+    
+    // Prepend older, time-ordered ticks stamped before both the oldest data
+    // of any tier and `before`. They go into the coarsest tier holding data
+    // (aggregated; ticks within its oldest candle's bucket are merged into
+    // that candle), or into the tick tier with what does not fit aggregated
+    // into the next tier. Returns the number of ticks accepted.
+    int backfill(const Tick* ticks, int n, TimeNs before);
+    
+    void clear();
+    
+    // Candles of intervalNs opening in [t0, t1) (both on the interval grid),
+    // appended to out in time order. Returns the number appended.
+    int aggregate(TimeNs t0, TimeNs t1, TimeNs intervalNs, std::vector<Candle>& out) const;
+    
+    // Whether a tier can build candles of intervalNs
+    static bool serves(HistoryTier tier, TimeNs intervalNs)
+    {
+        return tier == TIER_TICKS || intervalNs % RESOLUTION_NS[tier] == 0;
+    }
+    
+    // Oldest and newest data time over the tiers that serve intervalNs
+    // (false when they are all empty)
+    bool getTimeRange(TimeNs intervalNs, TimeNs& oldest, TimeNs& newest) const;
+    
+    const TickHistory& ticks() const { return m_ticks; }
+    const CandleHistory& candles(HistoryTier tier) const { return m_candles[tier]; }
+    int count(HistoryTier tier) const;
+    int capacity(HistoryTier tier) const;
+    size_t usedBytes(HistoryTier tier) const;
+    size_t reservedBytes(HistoryTier tier) const;   // Capacity in bytes
+    
+private:
+    TierConfig m_config[TIER_COUNT];
+    size_t m_byteLimit[TIER_COUNT];
+    TickHistory m_ticks;
+    CandleHistory m_candles[TIER_COUNT];   // TIER_SECONDS and TIER_MINUTES
+    std::vector<Candle> m_scratch[TIER_COUNT];  // Candles being moved into each tier
+    
+    Metric* m_compacted;
+    Metric* m_dropped;
+    Metric* m_tierBytes[TIER_COUNT];
+    
+    TimeNs startTime(HistoryTier tier) const;
+    void moveOlderThan(HistoryTier tier, TimeNs cut);
+    void fit(HistoryTier tier, int capacity);
+    void applyCapacity(HistoryTier tier);
+    void pushCandles(HistoryTier tier, const Candle* candles, int n);
+    int prependCandles(HistoryTier tier, const Candle* candles, int n);
+    void updateGauges();
+    
+    static int capacityFor(HistoryTier tier, size_t budgetBytes);
+    static void aggregateTicks(const Tick* ticks, int n, TimeNs intervalNs, std::vector<Candle>& out, size_t first);
+    static void aggregateCandles(const Candle* candles, int n, TimeNs intervalNs, std::vector<Candle>& out, size_t first);
+};
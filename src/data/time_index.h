@@ -0,0 +1,95 @@
+#pragma once
+
+#include "market_types.h"
+#include "ring_buffer.h"
+
+// ============================================================================
+// TIME INDEX
+// Range queries over time-ordered ring buffers (candles, ticks). Timestamps
+// are binary-searched in O(log n) and results are zero-copy views: at most
+// two contiguous spans, because the ring may wrap inside the range.
+//
+// Buffer requirements: count(), get(i) and view(begin, end) as provided by
+// RingBuffer, with elements in ascending time order; the element type
+// provides timeOf().
+// ============================================================================
+
+// First index whose time is >= t (count() when none)
+template <typename Buffer>
+int lowerBoundTime(const Buffer& buffer, TimeNs t)
+{
+    int lo = 0;
+    int hi = buffer.count();
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (timeOf(buffer.get(mid)) < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// First index whose time is > t (count() when none)
+template <typename Buffer>
+int upperBoundTime(const Buffer& buffer, TimeNs t)
+{
+    int lo = 0;
+    int hi = buffer.count();
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (timeOf(buffer.get(mid)) <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Elements with time in [t0, t1)
+template <typename T, typename Buffer>
+RangeView<T> queryTimeRange(const Buffer& buffer, TimeNs t0, TimeNs t1)
+{
+    int begin = lowerBoundTime(buffer, t0);
+    int end = t1 > t0 ? lowerBoundTime(buffer, t1) : begin;
+    return buffer.view(begin, end);
+}
+
+// Last n elements with time <= t (fewer when the buffer holds fewer)
+template <typename T, typename Buffer>
+RangeView<T> queryLastN(const Buffer& buffer, int n, TimeNs t)
+{
+    int end = upperBoundTime(buffer, t);
+    int begin = end > n ? end - n : 0;
+    return buffer.view(begin, end);
+}
+
+// Prepend time-ordered history older than both the buffer's oldest element
+// and limit. One pass over the input: elements at or after the cutoff, the
+// oldest ones beyond free capacity and anything before an ordering break
+// are dropped; the rest is copied in at most two memcpys. Returns the number
+// prepended.
+template <typename T, typename Buffer>
+int backfillTimeOrdered(Buffer& buffer, const T* items, int n, TimeNs limit)
+{
+    if (buffer.count() > 0 && timeOf(buffer.get(0)) < limit)
+        limit = timeOf(buffer.get(0));
+    
+    int end = n;
+    while (end > 0 && timeOf(items[end - 1]) >= limit)
+        end--;
+    
+    int space = buffer.capacity() - buffer.count();
+    int begin = end > space ? end - space : 0;
+    for (int i = end - 1; i > begin; i--)
+    {
+        if (timeOf(items[i - 1]) > timeOf(items[i]))
+        {
+            begin = i;
+            break;
+        }
+    }
+    return buffer.prependBulk(items + begin, end - begin);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+
+// ============================================================================
+// TRIPLE BUFFER
+// Single-writer, single-reader publication of whole values. The writer fills
+// back() and publishes it; the reader adopts the newest published slot and
+// keeps reading front() until its next acquire(). Both sides are wait-free:
+// each step is one atomic exchange of the shared middle slot index, so the
+// writer never waits for the reader and vice versa.
+// ============================================================================
+
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : m_back(0), m_front(1), m_middle(2) {}
+    
+    // Writer: slot to fill for the next publish()
+    T& back() { return m_slots[m_back]; }
+    
+    // Writer: make back() the newest value. Returns false when the previous
+    // value was never acquired; back() is then that unseen value.
+    bool publish()
+    {
+        int prev = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+        m_back = prev & INDEX_MASK;
+        return (prev & FRESH) == 0;
+    }
+    
+    // Reader: adopt the newest value if one was published since last time
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        
+        int prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & INDEX_MASK;
+        return true;
+    }
+    
+    // Reader: value adopted by the last successful acquire()
+    const T& front() const { return m_slots[m_front]; }
+    
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;     // Middle slot holds an unacquired value
+    
+    T m_slots[3];
+    int m_back;                     // Writer only
+    int m_front;                    // Reader only
+    std::atomic<int> m_middle;      // Slot index | FRESH
+};
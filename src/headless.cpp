@@ -0,0 +1,1389 @@
+// ============================================================================
+// HEADLESS RUNNER
+// Drives the ticker, chart and perf modules without a window or GPU so hot
+// paths can be profiled natively (perf, valgrind, sanitizers)
+//
+// Usage: headless [--frames N] [--dt SECONDS] [--interval INDEX] [--threaded]
+//                 [--stall SECONDS] [--backfill CANDLES] [--archive PATH] [--pan]
+//                 [--journal PATH] [--import CSV] [--load PATH]
+//                 [--export PATH [--compress]] [--switch-every FRAMES]
+//                 [--reaggregate-budget MS] [--memory-mb N]
+//                 [--reorder-window MS] [--feed-jitter MS] [--feed-rate N]
+//                 [--tick-policy keep|conflate|sample] [--policy-window MS]
+//        headless --bench kernels|backfill|journal|csv|export|reaggregate|jobs|history|reorder|throttle
+//                 [--journal PATH] [--jobs WORKERS]
+//        headless --write-csv PATH [--csv-rows N] [--csv-candles] [--interval INDEX]
+//        headless --write-archive PATH [--archive-candles N] [--interval INDEX]
+// ============================================================================
+
+#include "imgui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+// Application modules
+#include "data/data_pipeline.h"
+#include "data/candle_archive.h"
+#include "data/csv_import.h"
+#include "data/column_file.h"
+#include "data/tiered_history.h"
+#ifndef __EMSCRIPTEN__
+#include "data/tick_journal.h"
+#endif
+#include "chart/chart_renderer.h"
+#include "perf/perf_monitor.h"
+#include "perf/memory_budget.h"
+#include "kernels/price_kernels.h"
+#include "kernels/csv_scan.h"
+#include "platform/platform.h"
+#include "platform/job_system.h"
+
+// Application state (static: the tick history is too large for the stack)
+static DataPipeline g_Pipeline;
+static ChartRenderer g_ChartRenderer;
+static PerfMonitor g_PerfMonitor;
+static JobSystem g_Jobs;
+static CandleArchive g_Archive;
+static MemoryBudget g_Memory;
+#ifndef __EMSCRIPTEN__
+static TickJournal g_Journal;   // Native only (files, writer thread)
+#endif
+
+struct HeadlessOptions
+{
+    int frames;
+    float deltaTime;
+    int interval;   // Index into ChartRenderer::INTERVALS
+    const char* bench;  // Run a micro-benchmark instead of frames
+    bool threaded;      // Produce data on the pipeline worker thread
+    float stall;        // One frame of this length halfway through (hidden tab)
+    int backfill;       // Synthetic historical candles loaded before the first frame
+    const char* archive;        // Candle archive paged in behind the resident history
+    const char* writeArchive;   // Write a synthetic archive and exit
+    int archiveCandles;
+    bool pan;           // Scroll from the live end to the oldest candle over the run
+    const char* journal;        // Tick journal: recovered at start, appended during the run
+    const char* importCsv;      // CSV history loaded before the first frame
+    const char* writeCsv;       // Write a synthetic CSV and exit
+    int csvRows;
+    bool csvCandles;            // OHLC rows instead of ticks
+    const char* loadColumns;    // Column file loaded before the first frame
+    const char* exportColumns;  // Column file written after the last frame
+    bool compress;              // Delta/varint-encoded export
+    int switchEvery;            // Cycle the candle interval every N frames (0: never)
+    double reaggregateBudget;   // Re-aggregation ms per step (0: all at once)
+    int jobs;                   // Job system workers (0: cooperative, on the frame thread)
+    int memoryMB;               // Memory budget for data stores and caches (0: none)
+    double reorderWindow;       // Out-of-order tick window, ms (0: ticks applied on arrival)
+    double feedJitter;          // Simulated feed delay, ms (0: ticks arrive in order)
+    int feedRate;               // Simulated ticks per step
+    TickPolicy tickPolicy;      // Overload policy for ticks
+    double policyWindow;        // Its window, ms
+    
+    HeadlessOptions()
+        : frames(3600), deltaTime(1.0f / 60.0f), interval(0), bench(nullptr), threaded(false), stall(0.0f), backfill(0)
+        , archive(nullptr), writeArchive(nullptr), archiveCandles(1 << 21), pan(false), journal(nullptr)
+        , importCsv(nullptr), writeCsv(nullptr), csvRows(10000000), csvCandles(false)
+        , loadColumns(nullptr), exportColumns(nullptr), compress(false)
+        , switchEvery(0), reaggregateBudget(MockTicker::REAGGREGATE_BUDGET_MS), jobs(1), memoryMB(0)
+        , reorderWindow(0.0), feedJitter(0.0), feedRate(1), tickPolicy(TICK_KEEP_ALL), policyWindow(50.0)
+    {}
+};
+
+static bool parseArgs(int argc, char** argv, HeadlessOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            options.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--dt") == 0 && hasValue)
+            options.deltaTime = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue)
+            options.interval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bench") == 0 && hasValue)
+            options.bench = argv[++i];
+        else if (strcmp(argv[i], "--stall") == 0 && hasValue)
+            options.stall = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--backfill") == 0 && hasValue)
+            options.backfill = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--archive") == 0 && hasValue)
+            options.archive = argv[++i];
+        else if (strcmp(argv[i], "--write-archive") == 0 && hasValue)
+            options.writeArchive = argv[++i];
+        else if (strcmp(argv[i], "--archive-candles") == 0 && hasValue)
+            options.archiveCandles = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--journal") == 0 && hasValue)
+            options.journal = argv[++i];
+        else if (strcmp(argv[i], "--import") == 0 && hasValue)
+            options.importCsv = argv[++i];
+        else if (strcmp(argv[i], "--load") == 0 && hasValue)
+            options.loadColumns = argv[++i];
+        else if (strcmp(argv[i], "--export") == 0 && hasValue)
+            options.exportColumns = argv[++i];
+        else if (strcmp(argv[i], "--compress") == 0)
+            options.compress = true;
+        else if (strcmp(argv[i], "--switch-every") == 0 && hasValue)
+            options.switchEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--reaggregate-budget") == 0 && hasValue)
+            options.reaggregateBudget = atof(argv[++i]);
+        else if (strcmp(argv[i], "--jobs") == 0 && hasValue)
+            options.jobs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--memory-mb") == 0 && hasValue)
+            options.memoryMB = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--reorder-window") == 0 && hasValue)
+            options.reorderWindow = atof(argv[++i]);
+        else if (strcmp(argv[i], "--feed-jitter") == 0 && hasValue)
+            options.feedJitter = atof(argv[++i]);
+        else if (strcmp(argv[i], "--feed-rate") == 0 && hasValue)
+            options.feedRate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tick-policy") == 0 && hasValue)
+        {
+            const char* name = argv[++i];
+            if (strcmp(name, "keep") == 0)
+                options.tickPolicy = TICK_KEEP_ALL;
+            else if (strcmp(name, "conflate") == 0)
+                options.tickPolicy = TICK_CONFLATE;
+            else if (strcmp(name, "sample") == 0)
+                options.tickPolicy = TICK_SAMPLE;
+            else
+            {
+                fprintf(stderr, "Unknown tick policy: %s (keep, conflate, sample)\n", name);
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--policy-window") == 0 && hasValue)
+            options.policyWindow = atof(argv[++i]);
+        else if (strcmp(argv[i], "--write-csv") == 0 && hasValue)
+            options.writeCsv = argv[++i];
+        else if (strcmp(argv[i], "--csv-rows") == 0 && hasValue)
+            options.csvRows = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--csv-candles") == 0)
+            options.csvCandles = true;
+        else if (strcmp(argv[i], "--threaded") == 0)
+            options.threaded = true;
+        else if (strcmp(argv[i], "--pan") == 0)
+            options.pan = true;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--frames N] [--dt SECONDS] [--interval INDEX] [--threaded] [--stall SECONDS] [--backfill CANDLES] [--archive PATH] [--pan] [--journal PATH] [--import CSV] [--load PATH] [--export PATH] [--compress] [--switch-every FRAMES] [--reaggregate-budget MS] [--memory-mb N] [--reorder-window MS] [--feed-jitter MS] [--feed-rate N] [--tick-policy keep|conflate|sample] [--policy-window MS] [--jobs WORKERS] [--bench kernels|backfill|journal|csv|export|reaggregate|jobs|history|reorder|throttle] [--write-archive PATH] [--archive-candles N] [--write-csv PATH] [--csv-rows N] [--csv-candles]\n", argv[0]);
+            return false;
+        }
+    }
+    
+    if (options.interval < 0 || options.interval >= ChartRenderer::NUM_INTERVALS)
+        options.interval = 0;
+    return options.frames > 0 && options.deltaTime > 0.0f;
+}
+
+static void printReport(const std::vector<float>& frameTimes, const PerfMonitor& perf)
+{
+    std::vector<float> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    
+    double total = 0.0;
+    for (size_t i = 0; i < frameTimes.size(); i++)
+        total += frameTimes[i];
+    
+    size_t last = sorted.size() - 1;
+    printf("Frames:        %zu\n", frameTimes.size());
+    printf("CPU total:     %.1f ms\n", total);
+    printf("CPU per frame: avg %.3f  p50 %.3f  p99 %.3f  max %.3f ms\n",
+           total / frameTimes.size(), sorted[last * 50 / 100], sorted[last * 99 / 100], sorted[last]);
+    
+    const PerfStats& stats = perf.getStats();
+    printf("Draw:          %d verts, %d indices, %d cmds, overdraw %.2fx\n",
+           stats.vertices, stats.indices, stats.drawCalls, stats.overdraw);
+    
+    printf("\nMetrics:\n");
+    const MetricsRegistry& metrics = MetricsRegistry::instance();
+    for (int i = 0; i < metrics.count(); i++)
+    {
+        const Metric& metric = metrics.get(i);
+        if (metric.type() == METRIC_GAUGE)
+            printf("  %-28s %.6g\n", metric.name(), metric.gauge());
+        else
+            printf("  %-28s %lld\n", metric.name(), (long long)metric.value());
+    }
+}
+
+static void printMemory(const MemoryBudget& budget)
+{
+    printf("\nMemory budget: %.2f of %.2f MB\n", budget.getUsedBytes() / 1048576.0, budget.getBudget() / 1048576.0);
+    for (int i = 0; i < budget.getStoreCount(); i++)
+    {
+        const MemoryBudget::Store& store = budget.getStore(i);
+        char limit[32];
+        if (store.limitBytes == MemoryBudget::UNLIMITED)
+            snprintf(limit, sizeof(limit), "-");
+        else
+            snprintf(limit, sizeof(limit), "%.2f MB", store.limitBytes / 1048576.0);
+        printf("  %-16s %-8s %8.2f MB  limit %s\n", store.name, MemoryBudget::VALUE_NAMES[store.value],
+               store.usedBytes / 1048576.0, limit);
+    }
+}
+
+// ============================================================================
+// CSV HISTORY
+// Synthetic CSV rows with epoch millisecond timestamps: ticks
+// (timestamp,price,volume) ~17 ms apart, or OHLC candles at `interval`
+// seconds (interval > 0)
+// ============================================================================
+
+static void makeCsv(int rows, float interval, std::string& out)
+{
+    const long long start = 1700000000000LL;
+    long long step = interval > 0.0f ? llround(interval * 1000.0) : 17;
+    char line[128];
+    int price = 10000;  // Cents
+    
+    out.clear();
+    out.reserve((size_t)rows * (interval > 0.0f ? 48 : 28) + 64);
+    out += interval > 0.0f ? "timestamp,open,high,low,close,volume\n" : "timestamp,price,volume\n";
+    for (int i = 0; i < rows; i++)
+    {
+        int open = price;
+        price += rand() % 21 - 10;
+        if (price < 1000) price = 1000;
+        int n;
+        if (interval > 0.0f)
+        {
+            int high = (open > price ? open : price) + rand() % 8;
+            int low = (open < price ? open : price) - rand() % 8;
+            n = snprintf(line, sizeof(line), "%lld,%d.%02d,%d.%02d,%d.%02d,%d.%02d,%d\n", start + i * step,
+                         open / 100, open % 100, high / 100, high % 100, low / 100, low % 100, price / 100, price % 100, rand() % 1000);
+        }
+        else
+        {
+            n = snprintf(line, sizeof(line), "%lld,%d.%02d,%d\n", start + i * step, price / 100, price % 100, rand() % 100);
+        }
+        out.append(line, n);
+    }
+}
+
+// Scratch file for a bench in $TMPDIR (or /tmp), so benches run from any
+// directory
+static std::string benchPath(const char* name)
+{
+    const char* dir = getenv("TMPDIR");
+    if (!dir || !*dir)
+        dir = "/tmp";
+    return std::string(dir) + "/" + name;
+}
+
+// ============================================================================
+// KERNEL BENCHMARK
+// Runs scalar and dispatching (SIMD128 when built with -msimd128) kernels on
+// identical deterministic inputs and reports the speedup
+// ============================================================================
+
+template <typename Fn>
+static double timeBest(int repeats, Fn fn)
+{
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++)
+    {
+        double start = platformNowMs();
+        fn();
+        double elapsed = platformNowMs() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static void printBench(const char* name, double scalarMs, double dispatchMs, bool match)
+{
+    printf("  %-14s scalar %8.3f ms   dispatch %8.3f ms   speedup %.2fx  %s\n",
+           name, scalarMs, dispatchMs, scalarMs / dispatchMs, match ? "" : "MISMATCH");
+}
+
+static int runKernelBench()
+{
+    const int candleCount = 1 << 16;
+    const int tickCount = 1 << 20;
+    const int repeats = 20;
+    
+    // Deterministic inputs (fixed seed random walk on a 0.01 price grid)
+    srand(42);
+    PriceScale scale(0.01);
+    std::vector<Candle> candles(candleCount);
+    float price = 100.0f;
+    for (int i = 0; i < candleCount; i++)
+    {
+        float open = price;
+        price += ((float)rand() / (float)RAND_MAX - 0.5f);
+        float wick = (float)rand() / (float)RAND_MAX;
+        candles[i] = Candle(i * NS_PER_SECOND, scale.toTicks(open), scale.toTicks(fmaxf(open, price) + wick),
+                            scale.toTicks(fminf(open, price) - wick), scale.toTicks(price));
+    }
+    
+    std::vector<Tick> ticks(tickCount);
+    for (int i = 0; i < tickCount; i++)
+    {
+        price += ((float)rand() / (float)RAND_MAX - 0.5f) * 0.1f;
+        ticks[i] = Tick(scale.toTicks(price), (TimeNs)i * NS_PER_SECOND / 60);
+    }
+    
+    printf("Kernels (%s), %d candles, %d ticks, best of %d\n",
+           kernelsUseSimd() ? "SIMD128" : "scalar build", candleCount, tickCount, repeats);
+    
+    // Price range
+    PriceTicks minA = INT32_MAX, maxA = INT32_MIN, minB = INT32_MAX, maxB = INT32_MIN;
+    double scalarMs = timeBest(repeats, [&]() { minA = INT32_MAX; maxA = INT32_MIN; priceRangeScalar(candles.data(), candleCount, minA, maxA); });
+    double dispatchMs = timeBest(repeats, [&]() { minB = INT32_MAX; maxB = INT32_MIN; priceRange(candles.data(), candleCount, minB, maxB); });
+    printBench("priceRange", scalarMs, dispatchMs, minA == minB && maxA == maxB);
+    
+    // Price -> Y
+    PriceTransform transform;
+    transform.minTicks = (float)minA;
+    transform.scale = 500.0f / (float)(maxA - minA);
+    transform.baseY = 560.0f;
+    std::vector<float> yA(candleCount * 4), yB(candleCount * 4);
+    scalarMs = timeBest(repeats, [&]() { candlesToYScalar(candles.data(), candleCount, transform, yA.data()); });
+    dispatchMs = timeBest(repeats, [&]() { candlesToY(candles.data(), candleCount, transform, yB.data()); });
+    printBench("candlesToY", scalarMs, dispatchMs, yA == yB);
+    
+    // Tick bucketing
+    std::vector<int> bA(tickCount), bB(tickCount);
+    scalarMs = timeBest(repeats, [&]() { bucketTicksScalar(ticks.data(), tickCount, ticks[0].timestamp, 30 * NS_PER_SECOND, bA.data()); });
+    dispatchMs = timeBest(repeats, [&]() { bucketTicks(ticks.data(), tickCount, ticks[0].timestamp, 30 * NS_PER_SECOND, bB.data()); });
+    printBench("bucketTicks", scalarMs, dispatchMs, bA == bB);
+    
+    // CSV separator scan over tick rows
+    std::string text;
+    makeCsv(tickCount / 16, 0.0f, text);
+    int size = (int)text.size();
+    std::vector<uint32_t> sA(size), sB(size);
+    int countA = 0, countB = 0;
+    scalarMs = timeBest(repeats, [&]() { countA = scanSeparatorsScalar(text.data(), size, ',', sA.data()); });
+    dispatchMs = timeBest(repeats, [&]() { countB = scanSeparators(text.data(), size, ',', sB.data()); });
+    printBench("scanSeparators", scalarMs, dispatchMs, countA == countB && sA == sB);
+    
+    return 0;
+}
+
+// ============================================================================
+// HISTORICAL DATA
+// Synthetic history ending just before endTime (data clock; the session
+// starts at 0): a random walk run backwards from the live ticker's opening
+// price
+// ============================================================================
+
+static void makeHistory(int candleCount, float interval, TimeNs endTime, std::vector<Candle>& candles)
+{
+    PriceScale scale(0.01);
+    TimeNs intervalNs = secondsToNs(interval);
+    candles.resize(candleCount);
+    
+    float price = 100.0f;
+    for (int i = candleCount - 1; i >= 0; i--)
+    {
+        float close = price;
+        price += ((float)rand() / (float)RAND_MAX - 0.5f);
+        if (price < 10.0f) price = 10.0f;
+        float wick = (float)rand() / (float)RAND_MAX * 0.5f;
+        candles[i] = Candle(endTime - (TimeNs)(candleCount - i) * intervalNs, scale.toTicks(price),
+                            scale.toTicks(fmaxf(price, close) + wick),
+                            scale.toTicks(fminf(price, close) - wick), scale.toTicks(close));
+    }
+}
+
+static void makeTickHistory(int tickCount, std::vector<Tick>& ticks)
+{
+    PriceScale scale(0.01);
+    ticks.resize(tickCount);
+    
+    float price = 100.0f;
+    for (int i = tickCount - 1; i >= 0; i--)
+    {
+        ticks[i] = Tick(scale.toTicks(price), -(TimeNs)(tickCount - i) * NS_PER_SECOND / 60);
+        price += ((float)rand() / (float)RAND_MAX - 0.5f) * 0.1f;
+    }
+}
+
+static int writeCsv(const HeadlessOptions& options)
+{
+    std::string text;
+    makeCsv(options.csvRows, options.csvCandles ? ChartRenderer::INTERVALS[options.interval] : 0.0f, text);
+    FILE* file = fopen(options.writeCsv, "wb");
+    bool ok = file && fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (file && fclose(file) != 0)
+        ok = false;
+    if (!ok)
+    {
+        fprintf(stderr, "Failed to write %s\n", options.writeCsv);
+        return 1;
+    }
+    printf("Wrote %d %s rows (%.1f MB) to %s\n", options.csvRows, options.csvCandles ? "candle" : "tick",
+           text.size() / 1e6, options.writeCsv);
+    return 0;
+}
+
+static void printImport(const char* name, const CsvImporter& importer, double ms)
+{
+    printf("  %-14s %8.1f ms   %6.2f GB/s   %8.1f M rows/s   %lld ticks, %lld candles, %lld errors\n", name, ms,
+           importer.getBytes() / ms / 1e6, (importer.getTickRows() + importer.getCandleRows()) / ms / 1000.0,
+           (long long)importer.getTickRows(), (long long)importer.getCandleRows(), (long long)importer.getErrors());
+}
+
+// Parse throughput of in-memory tick and candle CSV, then of a CSV file
+// streamed through the platform file layer
+static int runCsvBench()
+{
+    const int tickRows = 8000000;
+    const int candleRows = 2000000;
+    const size_t piece = CsvImporter::CHUNK_BYTES;
+    static CsvImporter importer;    // Static: keeps its buffers between runs
+    
+    srand(42);
+    std::string ticks, candles;
+    makeCsv(tickRows, 0.0f, ticks);
+    makeCsv(candleRows, 60.0f, candles);
+    printf("CSV import, %d tick rows (%.0f MB), %d candle rows (%.0f MB)\n",
+           tickRows, ticks.size() / 1e6, candleRows, candles.size() / 1e6);
+    
+    const std::string* texts[] = { &ticks, &candles };
+    const char* names[] = { "ticks", "candles" };
+    for (int t = 0; t < 2; t++)
+    {
+        const std::string& text = *texts[t];
+        double ms = timeBest(3, [&]()
+        {
+            importer.begin(CsvImporter::Config());
+            for (size_t offset = 0; offset < text.size(); offset += piece)
+                importer.feed(text.data() + offset, text.size() - offset < piece ? text.size() - offset : piece);
+            importer.finish();
+        });
+        printImport(names[t], importer, ms);
+    }
+    
+    // Rows split across pieces: one completed by the next piece, and one
+    // that reaches MAX_LINE bytes without a newline (rejected)
+    std::string head = "timestamp,price,volume\n1700000000000,1.00,1\n1700000000017,1.";
+    std::string tail = "01,1\n1700000000034,1.02,1\n" + std::string(CsvImporter::MAX_LINE - 56, '1');
+    std::string end(56, '1');
+    importer.begin(CsvImporter::Config());
+    importer.feed(head.data(), head.size());
+    importer.feed(tail.data(), tail.size());
+    importer.feed(end.data(), end.size());
+    importer.finish();
+    bool split = importer.getTickRows() == 3 && importer.getErrors() == 1;
+    printf("  %-14s %lld ticks, %lld errors  %s\n", "split rows", (long long)importer.getTickRows(),
+           (long long)importer.getErrors(), split ? "" : "MISMATCH");
+    
+    std::string pathName = benchPath("csv_bench.csv");
+    const char* path = pathName.c_str();
+    FILE* file = fopen(path, "wb");
+    bool written = file && fwrite(ticks.data(), 1, ticks.size(), file) == ticks.size();
+    if (file && fclose(file) != 0)
+        written = false;
+    if (!written)
+    {
+        printf("  %-14s %s: write failed\n", "ticks (file)", path);
+        remove(path);
+        return 1;
+    }
+    
+    double start = platformNowMs();
+    importer.open(path, CsvImporter::Config());
+    while (importer.pump(1e9)) {}
+    printImport("ticks (file)", importer, platformNowMs() - start);
+    remove(path);
+    return importer.isFailed() || !split ? 1 : 0;
+}
+
+// Archive of history older than --backfill (so both can be loaded together)
+static int writeArchive(const HeadlessOptions& options)
+{
+    float interval = ChartRenderer::INTERVALS[options.interval];
+    TimeNs endTime = -(TimeNs)options.backfill * secondsToNs(interval);
+    
+    std::vector<Candle> candles;
+    makeHistory(options.archiveCandles, interval, endTime, candles);
+    if (!writeCandleArchive(options.writeArchive, candles.data(), (int64_t)candles.size(), secondsToNs(interval), 0.01))
+    {
+        fprintf(stderr, "Failed to write %s\n", options.writeArchive);
+        return 1;
+    }
+    printf("Wrote %d candles (%.0fs interval) to %s\n", options.archiveCandles, interval, options.writeArchive);
+    return 0;
+}
+
+// Loads full buffers of history into empty ones (the pipeline's backfill path
+// minus the thread handoff) and reports throughput
+static int runBackfillBench()
+{
+    const int repeats = 50;
+    static CandleBuffer candleBuffer;   // Static: too large for the stack
+    static TickHistory tickHistory;
+    static CandleBuffer snapshotCandles;
+    
+    srand(42);
+    std::vector<Candle> candles;
+    std::vector<Tick> ticks;
+    makeHistory(CandleBuffer::MAX_CANDLES, 60.0f, 0, candles);
+    makeTickHistory(TickHistory::MAX_TICKS, ticks);
+    
+    printf("Backfill, %d candles, %d ticks, best of %d\n", CandleBuffer::MAX_CANDLES, TickHistory::MAX_TICKS, repeats);
+    
+    int added = 0;
+    double ms = timeBest(repeats, [&]() { candleBuffer.clear(); added = candleBuffer.backfill(candles.data(), (int)candles.size(), 0); });
+    printf("  %-14s %8.3f ms   %8.1f M candles/s   %6.2f GB/s  %s\n", "candles", ms,
+           added / ms / 1000.0, added * sizeof(Candle) / ms / 1e6, added == (int)candles.size() ? "" : "SHORT");
+    
+    ms = timeBest(repeats, [&]() { tickHistory.clear(); added = tickHistory.backfill(ticks.data(), (int)ticks.size(), 0); });
+    printf("  %-14s %8.3f ms   %8.1f M ticks/s     %6.2f GB/s  %s\n", "ticks", ms,
+           added / ms / 1000.0, added * sizeof(Tick) / ms / 1e6, added == (int)ticks.size() ? "" : "SHORT");
+    
+    // Snapshot publish after a backfill (full copy) vs after one closed candle
+    ms = timeBest(repeats, [&]() { snapshotCandles.clear(); snapshotCandles.copyFrom(candleBuffer); });
+    printf("  %-14s %8.3f ms\n", "snapshot full", ms);
+    ms = timeBest(repeats, [&]() { candleBuffer.push(candles[0]); snapshotCandles.copyFrom(candleBuffer); });
+    printf("  %-14s %8.3f ms\n", "snapshot delta", ms);
+    
+    return 0;
+}
+
+static bool sameCandle(const Candle& a, const Candle& b)
+{
+    return a.time == b.time && a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close;
+}
+
+// Reference candles built straight from ticks (time order, no tiers)
+static void foldTick(std::vector<Candle>& candles, TimeNs intervalNs, const Tick& tick)
+{
+    TimeNs start = floorToInterval(tick.timestamp, intervalNs);
+    if (candles.empty() || candles.back().time != start)
+    {
+        candles.push_back(Candle(start, tick.price, tick.price, tick.price, tick.price));
+        return;
+    }
+    Candle& candle = candles.back();
+    if (tick.price > candle.high) candle.high = tick.price;
+    if (tick.price < candle.low) candle.low = tick.price;
+    candle.close = tick.price;
+}
+
+// Candles aggregate() builds from the tiers that do not match the reference
+// (both gap-free from the reference's first candle); -1 when out of range
+static int countMismatches(const std::vector<Candle>& candles, const std::vector<Candle>& reference, TimeNs intervalNs)
+{
+    int mismatched = 0;
+    for (size_t i = 0; i < candles.size(); i++)
+    {
+        int64_t index = (candles[i].time - reference[0].time) / intervalNs;
+        if (index < 0 || index >= (int64_t)reference.size())
+            return -1;
+        mismatched += !sameCandle(candles[i], reference[(size_t)index]);
+    }
+    return mismatched;
+}
+
+// Three days of ticks at 60/s through the tiered history with the default
+// windows and budgets, compacted once per simulated second, then candle
+// queries served across the tiers
+static int runHistoryBench()
+{
+    const int seconds = 3 * 86400;
+    const int ticksPerSecond = MockTicker::STEPS_PER_SECOND;
+    static TieredHistory history;   // Static: keeps the stack small
+    
+    srand(42);
+    PriceTicks price = 10000;
+    double worstCompactMs = 0.0;
+    double start = platformNowMs();
+    for (int s = 0; s < seconds; s++)
+    {
+        for (int i = 0; i < ticksPerSecond; i++)
+        {
+            price += rand() % 5 - 2;
+            history.append(Tick(price, (TimeNs)s * NS_PER_SECOND + (TimeNs)i * NS_PER_SECOND / ticksPerSecond));
+        }
+        double compactStart = platformNowMs();
+        history.compact((TimeNs)(s + 1) * NS_PER_SECOND);
+        worstCompactMs = std::max(worstCompactMs, platformNowMs() - compactStart);
+    }
+    double ms = platformNowMs() - start;
+    int64_t ticks = (int64_t)seconds * ticksPerSecond;
+    printf("Tiered history, %lld ticks (%.0f MB raw), %.1f ns per tick, worst compaction %.3f ms\n",
+           (long long)ticks, ticks * sizeof(Tick) / 1e6, ms * 1e6 / ticks, worstCompactMs);
+    
+    for (int t = 0; t < TIER_COUNT; t++)
+    {
+        HistoryTier tier = (HistoryTier)t;
+        int n = history.count(tier);
+        TimeNs span = 0;
+        if (n > 0)
+        {
+            span = tier == TIER_TICKS
+                ? history.ticks().get(n - 1).timestamp - history.ticks().get(0).timestamp
+                : history.candles(tier).get(n - 1).time - history.candles(tier).get(0).time + TieredHistory::RESOLUTION_NS[t];
+        }
+        printf("  %-6s %8d records  %6.2f MB of %6.2f MB  covering %8.2f h\n", TieredHistory::TIER_NAMES[t], n,
+               history.usedBytes(tier) / 1e6, history.getConfig(tier).budgetBytes / 1e6, nsToSeconds(span) / 3600.0);
+    }
+    
+    // The same ticks again, aggregated without tiers
+    const float intervals[3] = { 1.0f, 60.0f, 300.0f };
+    std::vector<Candle> reference[3];
+    srand(42);
+    price = 10000;
+    for (int s = 0; s < seconds; s++)
+    {
+        for (int i = 0; i < ticksPerSecond; i++)
+        {
+            price += rand() % 5 - 2;
+            Tick tick(price, (TimeNs)s * NS_PER_SECOND + (TimeNs)i * NS_PER_SECOND / ticksPerSecond);
+            for (int k = 0; k < 3; k++)
+                foldTick(reference[k], secondsToNs(intervals[k]), tick);
+        }
+    }
+    
+    bool ok = true;
+    std::vector<Candle> candles;
+    for (int i = 0; i < 3; i++)
+    {
+        TimeNs intervalNs = secondsToNs(intervals[i]);
+        TimeNs oldest, newest;
+        history.getTimeRange(intervalNs, oldest, newest);
+        candles.clear();
+        start = platformNowMs();
+        history.aggregate(floorToInterval(oldest, intervalNs), floorToInterval(newest, intervalNs) + intervalNs,
+                          intervalNs, candles);
+        double queryMs = platformNowMs() - start;
+        int mismatched = countMismatches(candles, reference[i], intervalNs);
+        printf("  %4.0fs candles: %6zu over %7.2f h in %.2f ms  %s\n", intervals[i], candles.size(),
+               nsToSeconds(newest - oldest) / 3600.0, queryMs, mismatched == 0 ? "exact" : "MISMATCH");
+        ok = ok && mismatched == 0;
+    }
+    
+    // Two hours of ticks through a tick tier of 4096 (compacting early to
+    // fit), part appended and the older part backfilled: into the tick tier
+    // with the rest split off into 1s candles, or into the 1s tier
+    const int backfillSeconds = 2 * 3600;
+    const int appendedSeconds[2] = { 30, 3600 };
+    std::vector<Tick> older(backfillSeconds * ticksPerSecond);
+    srand(7);
+    for (size_t i = 0; i < older.size(); i++)
+    {
+        price += rand() % 5 - 2;
+        older[i] = Tick(price, (TimeNs)i * NS_PER_SECOND / ticksPerSecond);
+    }
+    for (int k = 0; k < 3; k++)
+    {
+        reference[k].clear();
+        for (size_t i = 0; i < older.size(); i++)
+            foldTick(reference[k], secondsToNs(intervals[k]), older[i]);
+    }
+    
+    const char* const cases[2] = { "split", "1s tier" };
+    for (int c = 0; c < 2; c++)
+    {
+        history.clear();
+        TieredHistory::TierConfig config = TieredHistory::DEFAULT_CONFIG[TIER_TICKS];
+        config.budgetBytes = 4096 * sizeof(Tick);
+        history.configure(TIER_TICKS, config);
+        
+        int split = (backfillSeconds - appendedSeconds[c]) * ticksPerSecond;
+        for (size_t i = split; i < older.size(); i++)
+        {
+            history.append(older[i]);
+            if ((i + 1) % ticksPerSecond == 0 && c == 1)
+                history.compact(older[i].timestamp + 1);
+        }
+        int accepted = history.backfill(older.data(), split, older[split].timestamp);
+        
+        int mismatched = accepted == split ? 0 : -1;
+        for (int i = 0; i < 3 && mismatched == 0; i++)
+        {
+            TimeNs intervalNs = secondsToNs(intervals[i]);
+            candles.clear();
+            history.aggregate(0, floorToInterval(older.back().timestamp, intervalNs) + intervalNs, intervalNs, candles);
+            mismatched = candles.size() == reference[i].size() ? countMismatches(candles, reference[i], intervalNs) : -1;
+        }
+        printf("  backfill %-8s %7d of %7d ticks accepted, 1s/60s/300s candles %s\n", cases[c], accepted, split,
+               mismatched == 0 ? "exact" : "MISMATCH");
+        ok = ok && mismatched == 0;
+    }
+    history.configure(TIER_TICKS, TieredHistory::DEFAULT_CONFIG[TIER_TICKS]);
+    return ok ? 0 : 1;
+}
+
+// ============================================================================
+// JOB SYSTEM BENCHMARK
+// ============================================================================
+
+static std::atomic<uint64_t> g_JobSink(0);
+
+// About `user` microseconds of arithmetic
+static void spinJob(void* user)
+{
+    double endMs = platformNowMs() + (intptr_t)user / 1000.0;
+    uint64_t x = 1;
+    do
+    {
+        for (int i = 0; i < 64; i++)
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    } while (platformNowMs() < endMs);
+    g_JobSink.fetch_add(x, std::memory_order_relaxed);
+}
+
+static int g_LowJobsRun = 0;
+static void lowSpinJob(void* user)
+{
+    g_LowJobsRun++;
+    spinJob(user);
+}
+
+static void emptyJob(void*)
+{
+    g_JobSink.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Spawned from a worker: children land in its deque, idle workers steal them
+static JobCounter g_ChildJobs(0);
+static void fanOutJob(void*)
+{
+    for (int i = 0; i < 64; i++)
+        g_Jobs.submit(emptyJob, nullptr, JOB_NORMAL, &g_ChildJobs);
+}
+
+static int64_t metricValue(const char* name)
+{
+    const Metric* metric = MetricsRegistry::instance().find(name);
+    return metric ? metric->value() : 0;
+}
+
+// Threaded throughput (flat and nested submission), then the cooperative
+// scheduler over simulated frames, some of them late
+static int runJobBench(const HeadlessOptions& options)
+{
+    int workers = g_Jobs.start(options.jobs);
+    const int flatJobs = 200000;
+    const int parents = 2000;
+    printf("Job system, %d workers\n", workers);
+    
+    JobCounter counter(0);
+    double start = platformNowMs();
+    for (int i = 0; i < flatJobs; i++)
+        g_Jobs.submit(emptyJob, nullptr, JOB_NORMAL, &counter);
+    g_Jobs.wait(counter);
+    double ms = platformNowMs() - start;
+    printf("  %-18s %8.1f ms   %6.2f M jobs/s\n", "flat (shared FIFO)", ms, flatJobs / ms / 1000.0);
+    
+    int64_t stolenBefore = metricValue("jobs.stolen");
+    start = platformNowMs();
+    for (int i = 0; i < parents; i++)
+        g_Jobs.submit(fanOutJob, nullptr, JOB_NORMAL, &counter);
+    g_Jobs.wait(counter);
+    g_Jobs.wait(g_ChildJobs);
+    ms = platformNowMs() - start;
+    printf("  %-18s %8.1f ms   %6.2f M jobs/s   %lld stolen\n", "nested (deques)", ms,
+           parents * 65 / ms / 1000.0, (long long)(metricValue("jobs.stolen") - stolenBefore));
+    g_Jobs.stop();
+    
+    // Cooperative: frames render for 10 ms (30 ms when late), then run
+    // 0.5 ms jobs in what is left of the 16.7 ms budget
+    static JobSystem cooperative;
+    const int frames = 120;
+    for (int i = 0; i < 2000; i++)
+    {
+        if (i % 2)
+            cooperative.submit(lowSpinJob, (void*)(intptr_t)500, JOB_LOW);
+        else
+            cooperative.submit(spinJob, (void*)(intptr_t)500, JOB_NORMAL);
+    }
+    
+    int onTimeJobs = 0, onTimeFrames = 0, lateJobs = 0, lateFrames = 0, lateLow = 0;
+    double worstOverrunMs = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        cooperative.beginFrame();
+        double frameStart = platformNowMs();
+        bool slow = frame >= 60 && frame < 70;
+        spinJob((void*)(intptr_t)(slow ? 30000 : 10000));
+        
+        bool late = cooperative.isFrameLate();
+        int lowBefore = g_LowJobsRun;
+        int ran = cooperative.runMain();
+        double overrunMs = platformNowMs() - frameStart - JobSystem::DEFAULT_BUDGET_MS;
+        if (!slow && overrunMs > worstOverrunMs)
+            worstOverrunMs = overrunMs;
+        
+        if (late)
+        {
+            lateJobs += ran;
+            lateLow += g_LowJobsRun - lowBefore;
+            lateFrames++;
+        }
+        else
+        {
+            onTimeJobs += ran;
+            onTimeFrames++;
+        }
+        
+        // Idle until the next vsync
+        double idleMs = JobSystem::DEFAULT_BUDGET_MS - (platformNowMs() - frameStart);
+        if (idleMs > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(idleMs));
+    }
+    printf("  %-18s %5.1f jobs/frame on time (%d frames), %4.1f late (%d frames), worst overrun %.2f ms\n",
+           "cooperative", (double)onTimeJobs / onTimeFrames, onTimeFrames,
+           lateFrames ? (double)lateJobs / lateFrames : 0.0, lateFrames, worstOverrunMs);
+    printf("  %-18s %d low-priority jobs run in late frames, %lld deferrals\n", "", lateLow,
+           (long long)metricValue("jobs.deferred"));
+    cooperative.stop();
+    return 0;
+}
+
+// Full candle buffer and tick history written raw and encoded, then read back
+static int runExportBench()
+{
+    const int repeats = 10;
+    static CandleBuffer candleBuffer;   // Static: too large for the stack
+    static TickHistory tickHistory;
+    
+    srand(42);
+    std::vector<Candle> candles;
+    std::vector<Tick> ticks;
+    makeHistory(CandleBuffer::MAX_CANDLES, 60.0f, 0, candles);
+    makeTickHistory(TickHistory::MAX_TICKS, ticks);
+    candleBuffer.backfill(candles.data(), (int)candles.size(), 0);
+    tickHistory.backfill(ticks.data(), (int)ticks.size(), 0);
+    
+    std::string pathName = benchPath("export_bench.mcc");
+    const char* path = pathName.c_str();
+    double memoryBytes = (double)(candles.size() * sizeof(Candle) + ticks.size() * sizeof(Tick));
+    printf("Column export, %d candles, %d ticks (%.1f MB in memory), best of %d\n",
+           CandleBuffer::MAX_CANDLES, TickHistory::MAX_TICKS, memoryBytes / 1e6, repeats);
+    
+    bool ok = true;
+    const char* names[2] = { "raw", "delta varint" };
+    for (int compress = 0; compress < 2; compress++)
+    {
+        int64_t bytes = writeColumnFile(path, candleBuffer, tickHistory, secondsToNs(60.0f), 0.01, compress != 0);
+        if (bytes < 0)
+        {
+            printf("  %-14s %s: write failed\n", names[compress], path);
+            ok = false;
+            continue;
+        }
+        double ms = timeBest(repeats, [&]() {
+            bytes = writeColumnFile(path, candleBuffer, tickHistory, secondsToNs(60.0f), 0.01, compress != 0);
+        });
+        printf("  %-14s write %7.3f ms  %6.2f MB (%5.1f%%)", names[compress], ms, bytes / 1e6, 100.0 * bytes / memoryBytes);
+        
+        std::vector<Candle> readCandles;
+        std::vector<Tick> readTicks;
+        TimeNs intervalNs = 0;
+        double tickSize = 0.0;
+        bool read = false;
+        ms = timeBest(repeats, [&]() { read = readColumnFile(path, readCandles, readTicks, intervalNs, tickSize); });
+        
+        bool same = read && readCandles.size() == candles.size() && readTicks.size() == ticks.size();
+        for (size_t i = 0; same && i < candles.size(); i++)
+            same = readCandles[i].time == candles[i].time && readCandles[i].open == candles[i].open &&
+                   readCandles[i].high == candles[i].high && readCandles[i].low == candles[i].low &&
+                   readCandles[i].close == candles[i].close;
+        for (size_t i = 0; same && i < ticks.size(); i++)
+            same = readTicks[i].timestamp == ticks[i].timestamp && readTicks[i].price == ticks[i].price;
+        printf("   read %7.3f ms  %s\n", ms, same ? "" : "MISMATCH");
+        ok = ok && bytes > 0 && same;
+    }
+    
+    remove(path);
+    return ok ? 0 : 1;
+}
+
+// Interval switches over a full tick history: worst single call and total
+// time per switch, all at once vs time-sliced
+static int runReaggregateBench()
+{
+    const int switches = 20;
+    static MockTicker ticker;   // Static: too large for the stack
+    
+    srand(42);
+    std::vector<Tick> ticks;
+    makeTickHistory(TickHistory::MAX_TICKS, ticks);
+    ticker.backfill(nullptr, 0, ticks.data(), (int)ticks.size());
+    ticker.update(0.0f);
+    
+    printf("Re-aggregation, %d ticks, %d interval switches\n", TickHistory::MAX_TICKS, switches);
+    
+    const double budgets[3] = { 0.0, 1.0, 0.25 };
+    for (int b = 0; b < 3; b++)
+    {
+        ticker.setReaggregateBudget(budgets[b]);
+        double worstMs = 0.0;
+        double totalMs = 0.0;
+        int calls = 0;
+        for (int i = 0; i < switches; i++)
+        {
+            double start = platformNowMs();
+            ticker.setCandleInterval(ChartRenderer::INTERVALS[(i + 1) % ChartRenderer::NUM_INTERVALS], true);
+            double ms = platformNowMs() - start;
+            worstMs = std::max(worstMs, ms);
+            totalMs += ms;
+            calls++;
+            while (ticker.isReaggregating())
+            {
+                start = platformNowMs();
+                ticker.update(0.0f);
+                ms = platformNowMs() - start;
+                worstMs = std::max(worstMs, ms);
+                totalMs += ms;
+                calls++;
+            }
+        }
+        char label[32];
+        snprintf(label, sizeof(label), budgets[b] > 0.0 ? "budget %.2f ms" : "all at once", budgets[b]);
+        printf("  %-16s worst call %7.3f ms   %7.3f ms per switch   %5.1f calls per switch\n",
+               label, worstMs, totalMs / switches, (double)calls / switches);
+    }
+    return 0;
+}
+
+// Finalized candles rebuilt from the tick tier that do not match: the
+// high, low and close must come from the candle's ticks, bounded by the open
+// (the previous close); with no late ticks the open is that close exactly
+static int countTickMismatches(const CandleBuffer& candles, const TickHistory& ticks, TimeNs intervalNs, bool exactOpen)
+{
+    int mismatched = 0;
+    for (int i = 1; i < candles.count(); i++)
+    {
+        const Candle& candle = candles.get(i);
+        if (candle.time < ticks.getStartTime() + intervalNs)
+            continue;   // May have begun before the tier's oldest tick
+        RangeView<Tick> range = ticks.queryRange(candle.time, candle.time + intervalNs);
+        if (range.empty())
+            continue;
+        
+        PriceTicks high = INT32_MIN;
+        PriceTicks low = INT32_MAX;
+        PriceTicks close = 0;
+        for (int k = 0; k < range.count; k++)
+        {
+            const Tick& tick = ticks.get(range.first + k);
+            if (tick.price > high) high = tick.price;
+            if (tick.price < low) low = tick.price;
+            close = tick.price;
+        }
+        if (candle.open > high) high = candle.open;
+        if (candle.open < low) low = candle.open;
+        mismatched += candle.high != high || candle.low != low || candle.close != close ||
+                      (exactOpen && candle.open != candles.get(i - 1).close);
+    }
+    return mismatched;
+}
+
+// Ticks through the reorder window: in order, jittered within the window,
+// and jittered past it (late ticks corrected into finalized candles),
+// then the candles checked against the tick tier and a snapshot copy
+static int runReorderBench()
+{
+    const int updates = 2000;   // x stepsPerUpdate ticks
+    const int stepsPerUpdate = MockTicker::MAX_STEPS_PER_UPDATE - 1;   // Updates end at varying points in a candle
+    const double windows[3] = { 0.0, 50.0, 50.0 };
+    const double jitters[3] = { 0.0, 40.0, 200.0 };
+    const char* const labels[3] = { "in order", "within window", "past window" };
+    
+    printf("Reorder window, %d ticks per run\n", updates * stepsPerUpdate);
+    CandleBuffer* snapshot = new CandleBuffer();    // Heap: too large for the stack
+    bool ok = true;
+    for (int r = 0; r < 3; r++)
+    {
+        MockTicker* ticker = new MockTicker();  // Heap: too large for the stack
+        ticker->setReorderWindow(windows[r]);
+        ticker->setFeedJitter(jitters[r]);
+        snapshot->clear();
+        
+        srand(42);
+        int64_t reorderedBefore = metricValue("ticks.reordered");
+        int64_t lateBefore = metricValue("ticks.late");
+        int64_t correctedBefore = metricValue("candles.corrected");
+        double ms = 0.0;
+        for (int i = 0; i < updates; i++)
+        {
+            double start = platformNowMs();
+            ticker->update((float)stepsPerUpdate / MockTicker::STEPS_PER_SECOND);
+            ms += platformNowMs() - start;
+            
+            // Copied per update like the render snapshot is per frame, so
+            // corrections are caught up on from the log, not a full copy
+            snapshot->copyFrom(ticker->getCandleBuffer());
+        }
+        int64_t late = metricValue("ticks.late") - lateBefore;
+        
+        // Candles against their ticks, and the snapshot against the live buffer
+        const CandleBuffer& candles = ticker->getCandleBuffer();
+        int mismatched = countTickMismatches(candles, ticker->getTickHistory(),
+                                             secondsToNs(ticker->getCandleInterval()), late == 0);
+        for (int i = 0; i < candles.count() && i < snapshot->count(); i++)
+            mismatched += !sameCandle(candles.get(i), snapshot->get(i));
+        mismatched += candles.count() != snapshot->count();
+        ok = ok && mismatched == 0;
+        
+        printf("  %-14s window %3.0f ms  jitter %3.0f ms  %6.1f ns per tick  reordered %8lld  late %7lld  corrected %6lld  %s\n",
+               labels[r], windows[r], jitters[r], ms * 1e6 / ((double)updates * stepsPerUpdate),
+               (long long)(metricValue("ticks.reordered") - reorderedBefore), (long long)late,
+               (long long)(metricValue("candles.corrected") - correctedBefore), mismatched == 0 ? "exact" : "MISMATCH");
+        delete ticker;
+    }
+    delete snapshot;
+    return ok ? 0 : 1;
+}
+
+// A fast feed (100 ticks per step, 6000/s) under each overload policy:
+// cost per tick, ticks reaching history, and candles against keeping all
+static int runThrottleBench()
+{
+    const int updates = 200;    // x MAX_STEPS_PER_UPDATE steps
+    const int ticksPerStep = 100;
+    const double windowMs = 50.0;
+    const TimeNs checkNs = 60 * NS_PER_SECOND;  // Re-aggregated from history at the end
+    
+    printf("Tick policies, %d ticks per run, %.0f ms window\n",
+           updates * MockTicker::MAX_STEPS_PER_UPDATE * ticksPerStep, windowMs);
+    std::vector<Candle> reference;
+    std::vector<Candle> referenceHistory;
+    for (int p = 0; p < TICK_POLICY_COUNT; p++)
+    {
+        MockTicker* ticker = new MockTicker();  // Heap: too large for the stack
+        ticker->setFeedRate(ticksPerStep);
+        ticker->setTickPolicy((TickPolicy)p, windowMs);
+        
+        int64_t conflatedBefore = metricValue("ticks.conflated");
+        int64_t droppedBefore = metricValue("ticks.dropped");
+        double start = platformNowMs();
+        for (int i = 0; i < updates; i++)
+            ticker->update((float)MockTicker::MAX_STEPS_PER_UPDATE / MockTicker::STEPS_PER_SECOND);
+        double ms = platformNowMs() - start;
+        
+        // Finalized candles, and 1s candles re-aggregated from the tick tier
+        const CandleBuffer& buffer = ticker->getCandleBuffer();
+        std::vector<Candle> candles(buffer.count());
+        for (int i = 0; i < buffer.count(); i++)
+            candles[i] = buffer.get(i);
+        std::vector<Candle> history;
+        TimeNs end = floorToInterval(ticker->getElapsedTime(), NS_PER_SECOND);
+        ticker->getHistory().aggregate(end - checkNs, end, NS_PER_SECOND, history);
+        if (p == TICK_KEEP_ALL)
+        {
+            reference = candles;
+            referenceHistory = history;
+        }
+        
+        int mismatched = 0;
+        for (size_t i = 0; i < candles.size() && i < reference.size(); i++)
+            mismatched += !sameCandle(candles[i], reference[i]);
+        for (size_t i = 0; i < history.size() && i < referenceHistory.size(); i++)
+            mismatched += !sameCandle(history[i], referenceHistory[i]);
+        mismatched += candles.size() != reference.size() || history.size() != referenceHistory.size();
+        
+        const TickHistory& ticks = ticker->getTickHistory();
+        double tickSpan = ticks.count() > 1 ? nsToSeconds(ticks.get(ticks.count() - 1).timestamp - ticks.getStartTime()) : 0.0;
+        printf("  %-9s %6.1f ns per tick  conflated %8lld  dropped %8lld  %7.0f ticks/s kept  candles %s\n",
+               tickPolicyName((TickPolicy)p), ms * 1e6 / ((double)updates * MockTicker::MAX_STEPS_PER_UPDATE * ticksPerStep),
+               (long long)(metricValue("ticks.conflated") - conflatedBefore),
+               (long long)(metricValue("ticks.dropped") - droppedBefore),
+               tickSpan > 0.0 ? ticks.count() / tickSpan : 0.0, mismatched == 0 ? "exact" : "differ");
+        delete ticker;
+    }
+    return 0;
+}
+
+#ifndef __EMSCRIPTEN__
+static void countTicks(void* user, const Tick*, int count)
+{
+    *(int64_t*)user += count;
+}
+
+static void replayIntoTicker(void* user, const Tick* ticks, int count)
+{
+    ((MockTicker*)user)->replayTicks(ticks, count);
+}
+
+static void replayIntoPipeline(void* user, const Tick* ticks, int count)
+{
+    ((DataPipeline*)user)->replayTicks(ticks, count);
+}
+
+// Generate ticks as fast as the ticker allows, unjournaled and then journaled
+// (group commit with fdatasync), then recover the journal into a fresh ticker
+static int runJournalBench(const HeadlessOptions& options)
+{
+    const int updates = 4000;   // x MAX_STEPS_PER_UPDATE ticks
+    std::string defaultPath = benchPath("journal_bench.tj");
+    const char* path = options.journal ? options.journal : defaultPath.c_str();
+    static MockTicker plain;    // Static: too large for the stack
+    static MockTicker journaled;
+    static MockTicker recovered;
+    
+    remove(path);
+    printf("Journal, %d ticks, %s\n", updates * MockTicker::MAX_STEPS_PER_UPDATE, path);
+    
+    double start = platformNowMs();
+    int64_t ticks = 0;
+    for (int i = 0; i < updates; i++)
+        ticks += plain.update(MockTicker::MAX_STEPS_PER_UPDATE * (float)MockTicker::TICK_STEP);
+    double ms = platformNowMs() - start;
+    printf("  %-14s %8.1f ms   %8.2f M ticks/s\n", "ingest", ms, ticks / ms / 1000.0);
+    
+    TickJournal journal;
+    if (!journal.open(path, journaled.getPriceScale().tickSize, TickJournal::Config(), replayIntoTicker, &journaled))
+    {
+        fprintf(stderr, "Cannot open journal %s\n", path);
+        return 1;
+    }
+    journaled.setTickRecorder(&journal);
+    
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    int64_t commitsBefore = metrics.counter("journal.commits")->value();
+    start = platformNowMs();
+    ticks = 0;
+    for (int i = 0; i < updates; i++)
+        ticks += journaled.update(MockTicker::MAX_STEPS_PER_UPDATE * (float)MockTicker::TICK_STEP);
+    journal.close();    // Includes the final commit
+    ms = platformNowMs() - start;
+    int64_t commits = metrics.counter("journal.commits")->value() - commitsBefore;
+    printf("  %-14s %8.1f ms   %8.2f M ticks/s   %lld commits (%.0f ticks each)\n", "ingest+journal", ms,
+           ticks / ms / 1000.0, (long long)commits, commits > 0 ? (double)ticks / commits : 0.0);
+    
+    // Recovery: frame scan and CRC alone, then replayed through the ticker's
+    // aggregation
+    int64_t scanned = 0;
+    start = platformNowMs();
+    TickJournal scan;
+    scan.open(path, journaled.getPriceScale().tickSize, TickJournal::Config(), countTicks, &scanned);
+    ms = platformNowMs() - start;
+    scan.close();
+    printf("  %-14s %8.1f ms   %8.2f M ticks/s   %6.2f GB/s\n", "scan", ms,
+           scanned / ms / 1000.0, scanned * sizeof(JournalRecord) / ms / 1e6);
+    
+    start = platformNowMs();
+    TickJournal reopened;
+    bool ok = reopened.open(path, recovered.getPriceScale().tickSize, TickJournal::Config(), replayIntoTicker, &recovered);
+    ms = platformNowMs() - start;
+    reopened.close();
+    if (!ok)
+        return 1;
+    
+    int64_t bytes = reopened.getRecoveredTicks() * (int64_t)sizeof(JournalRecord);
+    printf("  %-14s %8.1f ms   %8.2f M ticks/s   %6.2f GB/s  %s\n", "recover", ms,
+           reopened.getRecoveredTicks() / ms / 1000.0, bytes / ms / 1e6,
+           recovered.getCurrentPrice() == journaled.getCurrentPrice() &&
+           recovered.getCandleBuffer().count() == journaled.getCandleBuffer().count() ? "" : "MISMATCH");
+    
+    remove(path);
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!parseArgs(argc, argv, options))
+        return 1;
+    
+    if (options.bench)
+    {
+        if (strcmp(options.bench, "kernels") == 0)
+            return runKernelBench();
+        if (strcmp(options.bench, "backfill") == 0)
+            return runBackfillBench();
+        if (strcmp(options.bench, "csv") == 0)
+            return runCsvBench();
+        if (strcmp(options.bench, "export") == 0)
+            return runExportBench();
+        if (strcmp(options.bench, "reaggregate") == 0)
+            return runReaggregateBench();
+        if (strcmp(options.bench, "jobs") == 0)
+            return runJobBench(options);
+        if (strcmp(options.bench, "history") == 0)
+            return runHistoryBench();
+        if (strcmp(options.bench, "reorder") == 0)
+            return runReorderBench();
+        if (strcmp(options.bench, "throttle") == 0)
+            return runThrottleBench();
+#ifndef __EMSCRIPTEN__
+        if (strcmp(options.bench, "journal") == 0)
+            return runJournalBench(options);
+#endif
+        fprintf(stderr, "Unknown benchmark: %s\n", options.bench);
+        return 1;
+    }
+    
+    if (options.writeArchive)
+        return writeArchive(options);
+    if (options.writeCsv)
+        return writeCsv(options);
+    
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1280, 720);
+    io.IniFilename = nullptr;
+    io.Fonts->Build();
+    
+    g_Pipeline.setLatencyTracker(&g_PerfMonitor.getLatencyTracker());
+    g_Pipeline.setReaggregateBudget(options.reaggregateBudget);
+    g_Pipeline.setReorderWindow(options.reorderWindow);
+    g_Pipeline.setFeedJitter(options.feedJitter);
+    g_Pipeline.setFeedRate(options.feedRate);
+    g_Pipeline.setTickPolicy(options.tickPolicy, options.policyWindow);
+    g_Pipeline.setCandleInterval(ChartRenderer::INTERVALS[options.interval], true);
+    g_ChartRenderer.getSettings().selectedInterval = options.interval;
+    if (options.backfill > 0)
+    {
+        BackfillBatch* batch = new BackfillBatch();
+        makeHistory(options.backfill, ChartRenderer::INTERVALS[options.interval], 0, batch->candles);
+        g_Pipeline.backfill(batch);
+    }
+    if (options.importCsv)
+    {
+        // Whole file before the first frame, ending where the live data starts
+        static CsvImporter importer;
+        CsvImporter::Config config;
+        config.tickSize = g_Pipeline.getPriceScale().tickSize;
+        importer.open(options.importCsv, config);
+        while (importer.pump(1e9)) {}
+        if (importer.isFailed())
+            fprintf(stderr, "Cannot import %s\n", options.importCsv);
+        else
+            printImport("import", importer, importer.getElapsedMs());
+        
+        BackfillBatch* batch = importer.takeBatch(0, secondsToNs(ChartRenderer::INTERVALS[options.interval]));
+        if (batch)
+            g_Pipeline.backfill(batch);
+    }
+    if (options.loadColumns)
+    {
+        BackfillBatch* batch = readColumnBatch(options.loadColumns, 0, secondsToNs(ChartRenderer::INTERVALS[options.interval]),
+                                               g_Pipeline.getPriceScale().tickSize);
+        if (batch)
+        {
+            printf("Loaded %d candles, %d ticks from %s\n", (int)batch->candles.size(), (int)batch->ticks.size(), options.loadColumns);
+            g_Pipeline.backfill(batch);
+        }
+        else
+        {
+            fprintf(stderr, "Cannot load %s\n", options.loadColumns);
+        }
+    }
+    if (options.archive)
+    {
+        if (g_Archive.open(options.archive))
+            g_ChartRenderer.setArchive(&g_Archive);
+        else
+            fprintf(stderr, "Cannot open archive %s\n", options.archive);
+    }
+#ifndef __EMSCRIPTEN__
+    if (options.journal)
+    {
+        if (g_Journal.open(options.journal, g_Pipeline.getPriceScale().tickSize, TickJournal::Config(), replayIntoPipeline, &g_Pipeline))
+        {
+            g_Pipeline.setTickRecorder(&g_Journal);
+            printf("Recovered %lld ticks from %s\n", (long long)g_Journal.getRecoveredTicks(), options.journal);
+        }
+        else
+        {
+            fprintf(stderr, "Cannot open journal %s\n", options.journal);
+        }
+    }
+#endif
+    if (options.memoryMB > 0)
+    {
+        g_Archive.registerMemory(g_Memory);
+        g_Pipeline.registerMemory(g_Memory);
+        g_Memory.setBudget((size_t)options.memoryMB << 20);
+        g_Memory.update();
+    }
+    if (options.threaded && !g_Pipeline.startWorker())
+        fprintf(stderr, "Built without threads, running the pipeline inline\n");
+    
+    std::vector<float> frameTimes;
+    frameTimes.reserve(options.frames);
+    
+    float chartHeight = io.DisplaySize.y * 0.8f;
+    float perfHeight = io.DisplaySize.y * 0.2f;
+    
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        double frameStart = platformNowMs();
+        float deltaTime = options.deltaTime;
+        if (options.stall > 0.0f && frame == options.frames / 2)
+            deltaTime = options.stall;
+        io.DeltaTime = deltaTime;
+        
+        g_PerfMonitor.beginFrame(deltaTime);
+        g_Jobs.beginFrame();
+        
+        g_PerfMonitor.beginZone(ZONE_DATA);
+        g_Memory.update();
+        if (options.switchEvery > 0 && frame > 0 && frame % options.switchEvery == 0)
+        {
+            int interval = (options.interval + frame / options.switchEvery) % ChartRenderer::NUM_INTERVALS;
+            g_ChartRenderer.getSettings().selectedInterval = interval;
+            g_Pipeline.setCandleInterval(ChartRenderer::INTERVALS[interval], true);
+        }
+        g_Pipeline.update(deltaTime);
+        const ChartSnapshot& snapshot = g_Pipeline.acquire();
+        g_PerfMonitor.endZone(ZONE_DATA);
+        
+        ImGui::NewFrame();
+        
+        g_PerfMonitor.beginZone(ZONE_CHART);
+        if (options.pan)
+            g_ChartRenderer.setScrollOffset(1.0f - (float)frame / (options.frames - 1));
+        g_ChartRenderer.render("MOCK/USD", snapshot, chartHeight);
+        g_PerfMonitor.setComponentStats(g_ChartRenderer.getDrawStats(), ChartRenderer::DRAW_COMPONENT_COUNT);
+        g_PerfMonitor.endZone(ZONE_CHART);
+        
+        g_PerfMonitor.beginZone(ZONE_PERF_UI);
+        g_PerfMonitor.renderWindow(chartHeight, perfHeight, io.DisplaySize.x);
+        g_PerfMonitor.endZone(ZONE_PERF_UI);
+        
+        g_PerfMonitor.beginZone(ZONE_IMGUI_RENDER);
+        ImGui::Render();
+        g_PerfMonitor.endZone(ZONE_IMGUI_RENDER);
+        
+        g_PerfMonitor.endFrame(ImGui::GetDrawData());
+        g_PerfMonitor.onPresent();
+        
+        g_PerfMonitor.beginZone(ZONE_JOBS);
+        g_Jobs.runMain();
+        g_PerfMonitor.endZone(ZONE_JOBS);
+        
+        double frameMs = platformNowMs() - frameStart;
+        frameTimes.push_back((float)frameMs);
+        
+        // Pace frames in real time so the worker advances between them
+        if (g_Pipeline.isThreaded() && frameMs < options.deltaTime * 1000.0)
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(options.deltaTime * 1000.0 - frameMs));
+    }
+    
+    g_Pipeline.stopWorker();
+#ifndef __EMSCRIPTEN__
+    g_Journal.close();
+#endif
+    if (options.exportColumns)
+    {
+        // Inline now, so the export is written before this returns
+        if (g_Pipeline.exportData(options.exportColumns, options.compress))
+            printf("Exported to %s\n", options.exportColumns);
+        else
+            fprintf(stderr, "Cannot export %s\n", options.exportColumns);
+    }
+    printReport(frameTimes, g_PerfMonitor);
+    if (options.memoryMB > 0)
+        printMemory(g_Memory);
+    
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "crc32c.h"
+#include <string.h>
+
+// Reflected polynomial 0x1EDC6F41
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+
+struct Crc32cTables
+{
+    uint32_t t[8][256];
+    
+    Crc32cTables()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+            t[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            for (int s = 1; s < 8; s++)
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        }
+    }
+};
+
+static const Crc32cTables g_Tables;
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    const uint32_t (*t)[256] = g_Tables.t;
+    crc = ~crc;
+    
+    // Little-endian 8-byte steps
+    while (size >= 8)
+    {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    
+    return ~crc;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// CRC-32C (Castagnoli)
+// Checksums for framed on-disk records. Table-driven, 8 bytes per step
+// (slicing-by-8), portable to WASM. Chain calls by passing the previous
+// result as crc.
+// ============================================================================
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
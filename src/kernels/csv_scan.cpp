@@ -0,0 +1,66 @@
+#include "csv_scan.h"
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+int scanSeparatorsScalar(const char* data, int size, char delimiter, uint32_t* outOffsets)
+{
+    int count = 0;
+    for (int i = 0; i < size; i++)
+    {
+        if (data[i] == delimiter || data[i] == '\n')
+            outOffsets[count++] = (uint32_t)i;
+    }
+    return count;
+}
+
+#if defined(__wasm_simd128__) || defined(__SSE2__)
+
+// Bit i set where data[i] is a separator, for 16 bytes
+static inline uint32_t separatorMask16(const char* data, char delimiter)
+{
+#if defined(__wasm_simd128__)
+    v128_t bytes = wasm_v128_load(data);
+    v128_t hits = wasm_v128_or(wasm_i8x16_eq(bytes, wasm_i8x16_splat(delimiter)), wasm_i8x16_eq(bytes, wasm_i8x16_splat('\n')));
+    return wasm_i8x16_bitmask(hits);
+#else
+    __m128i bytes = _mm_loadu_si128((const __m128i*)data);
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(delimiter)), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+    return (uint32_t)_mm_movemask_epi8(hits);
+#endif
+}
+
+int scanSeparators(const char* data, int size, char delimiter, uint32_t* outOffsets)
+{
+    int count = 0;
+    int i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        uint64_t mask = (uint64_t)separatorMask16(data + i, delimiter) |
+                        (uint64_t)separatorMask16(data + i + 16, delimiter) << 16 |
+                        (uint64_t)separatorMask16(data + i + 32, delimiter) << 32 |
+                        (uint64_t)separatorMask16(data + i + 48, delimiter) << 48;
+        while (mask)
+        {
+            outOffsets[count++] = (uint32_t)(i + __builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+    
+    int tail = scanSeparatorsScalar(data + i, size - i, delimiter, outOffsets + count);
+    for (int k = 0; k < tail; k++)
+        outOffsets[count + k] += (uint32_t)i;
+    return count + tail;
+}
+
+#else
+
+int scanSeparators(const char* data, int size, char delimiter, uint32_t* outOffsets)
+{
+    return scanSeparatorsScalar(data, size, delimiter, outOffsets);
+}
+
+#endif
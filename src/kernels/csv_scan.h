@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================================
+// CSV SEPARATOR SCAN
+// Offsets of field delimiters and newlines in a block of text, so row parsing
+// walks separators instead of bytes. The dispatching version compares 64
+// bytes per step (SSE2 natively, SIMD128 when built with -msimd128) and
+// turns the match masks into offsets with count-trailing-zeros.
+// ============================================================================
+
+// Writes the offset of every `delimiter` and '\n' in data[0, size) to
+// outOffsets (room for size entries), ascending; returns how many
+int scanSeparators(const char* data, int size, char delimiter, uint32_t* outOffsets);
+int scanSeparatorsScalar(const char* data, int size, char delimiter, uint32_t* outOffsets);
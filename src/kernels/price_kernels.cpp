@@ -0,0 +1,131 @@
+#include "price_kernels.h"
+#include <stddef.h>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+// ============================================================================
+// SCALAR KERNELS
+// ============================================================================
+
+void priceRangeScalar(const Candle* candles, int count, PriceTicks& minPrice, PriceTicks& maxPrice)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Candle& c = candles[i];
+        if (c.low < minPrice) minPrice = c.low;
+        if (c.high > maxPrice) maxPrice = c.high;
+    }
+}
+
+void candlesToYScalar(const Candle* candles, int count, const PriceTransform& transform, float* outY)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Candle& c = candles[i];
+        outY[i * 4 + 0] = transform.toY(c.open);
+        outY[i * 4 + 1] = transform.toY(c.high);
+        outY[i * 4 + 2] = transform.toY(c.low);
+        outY[i * 4 + 3] = transform.toY(c.close);
+    }
+}
+
+void bucketTicksScalar(const Tick* ticks, int count, TimeNs startTime, TimeNs interval, int* outBucket)
+{
+    for (int i = 0; i < count; i++)
+    {
+        outBucket[i] = (int)((ticks[i].timestamp - startTime) / interval);
+    }
+}
+
+// ============================================================================
+// SIMD128 KERNELS
+// Candle stores open/high/low/close as 4 consecutive int32 price ticks, so one
+// v128 load covers a whole candle. Tick bucketing needs 64-bit integer
+// division, which SIMD128 lacks, so it stays scalar.
+// ============================================================================
+
+#ifdef __wasm_simd128__
+
+static_assert(offsetof(Candle, close) == offsetof(Candle, open) + 3 * sizeof(PriceTicks), "Candle OHLC must be contiguous");
+static_assert(sizeof(PriceTicks) == 4, "Candle OHLC must fill one v128");
+
+bool kernelsUseSimd()
+{
+    return true;
+}
+
+void priceRange(const Candle* candles, int count, PriceTicks& minPrice, PriceTicks& maxPrice)
+{
+    // Lane 1 tracks high, lane 2 tracks low; two accumulators hide latency
+    v128_t vmin0 = wasm_i32x4_splat(minPrice);
+    v128_t vmax0 = wasm_i32x4_splat(maxPrice);
+    v128_t vmin1 = vmin0;
+    v128_t vmax1 = vmax0;
+    
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        v128_t a = wasm_v128_load(&candles[i].open);
+        v128_t b = wasm_v128_load(&candles[i + 1].open);
+        vmin0 = wasm_i32x4_min(vmin0, a);
+        vmax0 = wasm_i32x4_max(vmax0, a);
+        vmin1 = wasm_i32x4_min(vmin1, b);
+        vmax1 = wasm_i32x4_max(vmax1, b);
+    }
+    if (i < count)
+    {
+        v128_t a = wasm_v128_load(&candles[i].open);
+        vmin0 = wasm_i32x4_min(vmin0, a);
+        vmax0 = wasm_i32x4_max(vmax0, a);
+    }
+    
+    v128_t vmin = wasm_i32x4_min(vmin0, vmin1);
+    v128_t vmax = wasm_i32x4_max(vmax0, vmax1);
+    minPrice = wasm_i32x4_extract_lane(vmin, 2);
+    maxPrice = wasm_i32x4_extract_lane(vmax, 1);
+}
+
+void candlesToY(const Candle* candles, int count, const PriceTransform& transform, float* outY)
+{
+    v128_t minTicks = wasm_f32x4_splat(transform.minTicks);
+    v128_t scale = wasm_f32x4_splat(transform.scale);
+    v128_t baseY = wasm_f32x4_splat(transform.baseY);
+    
+    for (int i = 0; i < count; i++)
+    {
+        v128_t ohlc = wasm_f32x4_convert_i32x4(wasm_v128_load(&candles[i].open));
+        v128_t y = wasm_f32x4_sub(baseY, wasm_f32x4_mul(wasm_f32x4_sub(ohlc, minTicks), scale));
+        wasm_v128_store(outY + i * 4, y);
+    }
+}
+
+void bucketTicks(const Tick* ticks, int count, TimeNs startTime, TimeNs interval, int* outBucket)
+{
+    bucketTicksScalar(ticks, count, startTime, interval, outBucket);
+}
+
+#else
+
+bool kernelsUseSimd()
+{
+    return false;
+}
+
+void priceRange(const Candle* candles, int count, PriceTicks& minPrice, PriceTicks& maxPrice)
+{
+    priceRangeScalar(candles, count, minPrice, maxPrice);
+}
+
+void candlesToY(const Candle* candles, int count, const PriceTransform& transform, float* outY)
+{
+    candlesToYScalar(candles, count, transform, outY);
+}
+
+void bucketTicks(const Tick* ticks, int count, TimeNs startTime, TimeNs interval, int* outBucket)
+{
+    bucketTicksScalar(ticks, count, startTime, interval, outBucket);
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../chart/candle.h"
+#include "../data/tick.h"
+
+// ============================================================================
+// PRICE KERNELS
+// Hot loops over candles and ticks. Built with -msimd128 the dispatching
+// versions use WASM SIMD128 (4 lanes); otherwise they run the scalar code.
+// The *Scalar versions are always available for benchmarking/validation.
+// ============================================================================
+
+// Affine price -> screen Y mapping in price ticks: y = baseY - (ticks - minTicks) * scale
+struct PriceTransform
+{
+    float minTicks;
+    float scale;    // canvasHeight / range (pixels per price tick)
+    float baseY;    // Bottom edge of the canvas
+    
+    float toY(PriceTicks ticks) const { return baseY - ((float)ticks - minTicks) * scale; }
+};
+
+// True when the dispatching kernels were compiled with SIMD128
+bool kernelsUseSimd();
+
+// Lowest low / highest high over count candles (min/max are updated in place,
+// so callers can fold several contiguous segments)
+void priceRange(const Candle* candles, int count, PriceTicks& minPrice, PriceTicks& maxPrice);
+void priceRangeScalar(const Candle* candles, int count, PriceTicks& minPrice, PriceTicks& maxPrice);
+
+// Y coordinates of open, high, low, close for each candle (4 floats per candle)
+void candlesToY(const Candle* candles, int count, const PriceTransform& transform, float* outY);
+void candlesToYScalar(const Candle* candles, int count, const PriceTransform& transform, float* outY);
+
+// Candle bucket index of each tick: (timestamp - startTime) / interval, exact
+// integer division (ticks must not precede startTime)
+void bucketTicks(const Tick* ticks, int count, TimeNs startTime, TimeNs interval, int* outBucket);
+void bucketTicksScalar(const Tick* ticks, int count, TimeNs startTime, TimeNs interval, int* outBucket);
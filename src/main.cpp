@@ -2,20 +2,35 @@
 // MARKET CHART APPLICATION
 // A real-time candlestick chart built with ImGui + WebAssembly
 // Demonstrates superior performance vs React/JS
+// Also builds natively (SDL2 + desktop GL) for profiling, see Makefile
 // ============================================================================
 
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_opengl3.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <SDL.h>
-#include <emscripten.h>
+#ifdef __EMSCRIPTEN__
 #include <SDL_opengles2.h>
+#else
+#include <SDL_opengl.h>
+#endif
 
 // Application modules
-#include "data/mock_ticker.h"
+#include "data/data_pipeline.h"
+#include "data/candle_archive.h"
+#include "data/csv_import.h"
+#include "data/column_file.h"
+#ifndef __EMSCRIPTEN__
+#include "data/tick_journal.h"
+#endif
 #include "chart/chart_renderer.h"
 #include "perf/perf_monitor.h"
+#include "perf/memory_budget.h"
+#include "platform/platform.h"
+#include "platform/job_system.h"
 
 // ============================================================================
 // APPLICATION STATE
@@ -26,9 +41,18 @@ static SDL_GLContext g_GLContext = nullptr;
 static ImVec4 g_ClearColor = ImVec4(0.10f, 0.10f, 0.12f, 1.00f);
 
 // Application modules
-static MockTicker g_Ticker;
+static DataPipeline g_Pipeline;
 static ChartRenderer g_ChartRenderer;
 static PerfMonitor g_PerfMonitor;
+static CandleArchive g_Archive;
+static JobSystem g_Jobs;
+static CsvImporter g_Importer;
+static MemoryBudget g_Memory;
+static bool g_ImportPending = false;
+static std::atomic<bool> g_ImportDone(false);
+#ifndef __EMSCRIPTEN__
+static TickJournal g_Journal;
+#endif
 
 // ============================================================================
 // MAIN LOOP
@@ -37,31 +61,87 @@ static PerfMonitor g_PerfMonitor;
 // Track interval selection changes
 static int g_LastIntervalSelection = 0;
 
+// Parse time per CSV import job before it resubmits itself
+static const double IMPORT_SLICE_MS = 4.0;
+
+// Memory budget for the data stores and caches. A fixed heap (FIXED_HEAP_MB)
+// sets it to what the heap leaves after HEAP_RESERVE_MB for ImGui, thread
+// stacks, import batches and other transient buffers.
+#ifndef MEMORY_BUDGET_MB
+#define MEMORY_BUDGET_MB 32
+#endif
+static const size_t HEAP_RESERVE_MB = 16;
+
+// Job workers beside the render thread and the pipeline worker (WASM:
+// PTHREAD_POOL_SIZE in the Makefile covers both)
+static const int MAX_JOB_WORKERS = 2;
+
+// Parse a slice of the import per job, then queue the rest behind other
+// jobs. In WASM the reads complete in fetch callbacks on the main thread, so
+// the job stays there.
+static void importJob(void* user);
+
+static void queueImportJob()
+{
+#ifdef __EMSCRIPTEN__
+    g_Jobs.submitMain(importJob, nullptr, JOB_LOW);
+#else
+    g_Jobs.submit(importJob, nullptr, JOB_LOW);
+#endif
+}
+
+static void importJob(void*)
+{
+    if (g_Importer.pump(IMPORT_SLICE_MS))
+        queueImportJob();
+    else
+        g_ImportDone.store(true, std::memory_order_release);
+}
+
 void main_loop()
 {
     ImGuiIO& io = ImGui::GetIO();
     
+    // Update performance monitoring
+    g_PerfMonitor.beginFrame(io.DeltaTime);
+    g_Jobs.beginFrame();
+    
     // Check if interval selection changed
+    g_PerfMonitor.beginZone(ZONE_DATA);
+    g_Memory.update();
     int currentInterval = g_ChartRenderer.getSettings().selectedInterval;
     if (currentInterval != g_LastIntervalSelection)
     {
         bool preserveHistory = g_ChartRenderer.getSettings().preserveHistory;
-        g_Ticker.setCandleInterval(ChartRenderer::INTERVALS[currentInterval], preserveHistory);
+        g_Pipeline.setCandleInterval(ChartRenderer::INTERVALS[currentInterval], preserveHistory);
         g_LastIntervalSelection = currentInterval;
     }
     
-    // Update performance monitoring
-    g_PerfMonitor.beginFrame(io.DeltaTime);
+    // Update price data (no-op when the worker thread produces it) and
+    // adopt the latest snapshot; everything drawn this frame reads from it
+    g_Pipeline.update(io.DeltaTime);
+    const ChartSnapshot& snapshot = g_Pipeline.acquire();
     
-    // Update price data
-    g_Ticker.update(io.DeltaTime);
+    // Hand a CSV import over once its jobs parsed everything
+    if (g_ImportPending && g_ImportDone.load(std::memory_order_acquire))
+    {
+        g_ImportPending = false;
+        BackfillBatch* batch = g_Importer.isFailed() ? nullptr : g_Importer.takeBatch(0, secondsToNs(snapshot.candleInterval));
+        if (batch)
+            g_Pipeline.backfill(batch);
+    }
+    g_PerfMonitor.endZone(ZONE_DATA);
     
     // Poll SDL events
+    g_PerfMonitor.beginZone(ZONE_EVENTS);
     SDL_Event event;
     while (SDL_PollEvent(&event))
     {
         ImGui_ImplSDL2_ProcessEvent(&event);
+        if (event.type == SDL_QUIT)
+            platformRequestQuit();
     }
+    g_PerfMonitor.endZone(ZONE_EVENTS);
     
     // Start new ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
@@ -73,33 +153,26 @@ void main_loop()
     float perfHeight = io.DisplaySize.y * 0.2f;
     
     // Render chart
-    g_ChartRenderer.render(
-        "MOCK/USD",
-        g_Ticker.getCurrentPrice(),
-        g_Ticker.getCandleBuffer(),
-        g_Ticker.getCurrentCandle(),
-        g_Ticker.getTicksPerSecond(),
-        g_Ticker.getCandleInterval(),
-        chartHeight
-    );
+    g_PerfMonitor.beginZone(ZONE_CHART);
+    g_ChartRenderer.render("MOCK/USD", snapshot, chartHeight);
+    g_PerfMonitor.setComponentStats(g_ChartRenderer.getDrawStats(), ChartRenderer::DRAW_COMPONENT_COUNT);
+    g_PerfMonitor.endZone(ZONE_CHART);
     
     // Render performance panel
-    g_PerfMonitor.renderWindow(
-        chartHeight,
-        perfHeight,
-        io.DisplaySize.x,
-        g_Ticker.getTicksPerSecond(),
-        g_Ticker.getCandleBuffer().count(),
-        g_Ticker.getCandleBuffer().maxCandles()
-    );
+    g_PerfMonitor.beginZone(ZONE_PERF_UI);
+    g_PerfMonitor.renderWindow(chartHeight, perfHeight, io.DisplaySize.x);
+    g_PerfMonitor.endZone(ZONE_PERF_UI);
     
     // Finalize ImGui frame
+    g_PerfMonitor.beginZone(ZONE_IMGUI_RENDER);
     ImGui::Render();
+    g_PerfMonitor.endZone(ZONE_IMGUI_RENDER);
     
     // Update performance stats with draw data
     g_PerfMonitor.endFrame(ImGui::GetDrawData());
     
     // OpenGL render
+    g_PerfMonitor.beginZone(ZONE_PRESENT);
     glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
     glClearColor(
         g_ClearColor.x * g_ClearColor.w, 
@@ -110,6 +183,14 @@ void main_loop()
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     SDL_GL_SwapWindow(g_Window);
+    g_PerfMonitor.onPresent();
+    g_PerfMonitor.endZone(ZONE_PRESENT);
+    
+    // Render-thread jobs (all of them without threads) in what is left of
+    // the frame budget
+    g_PerfMonitor.beginZone(ZONE_JOBS);
+    g_Jobs.runMain();
+    g_PerfMonitor.endZone(ZONE_JOBS);
 }
 
 // ============================================================================
@@ -124,11 +205,19 @@ bool initSDL()
         return false;
     }
     
+#ifdef __EMSCRIPTEN__
     // Setup OpenGL ES 3.0 for WebGL 2.0
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+#else
+    // Setup desktop OpenGL 3.0 for native builds
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+#endif
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
@@ -173,7 +262,11 @@ bool initImGui()
     
     ImGui::StyleColorsDark();
     
+#ifdef __EMSCRIPTEN__
     const char* glsl_version = "#version 300 es";
+#else
+    const char* glsl_version = "#version 130";
+#endif
     ImGui_ImplSDL2_InitForOpenGL(g_Window, g_GLContext);
     ImGui_ImplOpenGL3_Init(glsl_version);
     
@@ -195,7 +288,14 @@ void shutdown()
 // ENTRY POINT
 // ============================================================================
 
-int main(int, char**)
+#ifndef __EMSCRIPTEN__
+static void replayJournal(void* user, const Tick* ticks, int count)
+{
+    ((DataPipeline*)user)->replayTicks(ticks, count);
+}
+#endif
+
+int main(int argc, char** argv)
 {
     if (!initSDL())
         return 1;
@@ -203,11 +303,117 @@ int main(int, char**)
     if (!initImGui())
         return 1;
     
-    // Start main loop (Emscripten will handle the loop)
-    // 0 = use requestAnimationFrame, 1 = simulate infinite loop
-    emscripten_set_main_loop(main_loop, 0, 1);
+    g_Pipeline.setLatencyTracker(&g_PerfMonitor.getLatencyTracker());
+    
+    // Older history paged in on pan (`make archive`); WASM fetches it from
+    // the server, native takes a path argument
+#ifdef __EMSCRIPTEN__
+    const char* archivePath = "history.mca";
+    const char* importPath = "history.csv";
+#else
+    // Native: market-chart [--journal PATH] [--import CSV] [--load PATH]
+    //                      [--export PATH [--compress]] [--memory-mb N] [ARCHIVE]
+    const char* archivePath = nullptr;
+    const char* importPath = nullptr;
+    const char* journalPath = nullptr;
+    const char* loadPath = nullptr;
+    const char* exportPath = nullptr;
+    bool compressExport = false;
+    size_t memoryBudgetMB = MEMORY_BUDGET_MB;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc)
+            journalPath = argv[++i];
+        else if (strcmp(argv[i], "--import") == 0 && i + 1 < argc)
+            importPath = argv[++i];
+        else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc)
+            loadPath = argv[++i];
+        else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc)
+            exportPath = argv[++i];
+        else if (strcmp(argv[i], "--compress") == 0)
+            compressExport = true;
+        else if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc)
+            memoryBudgetMB = (size_t)atoi(argv[++i]);
+        else
+            archivePath = argv[i];
+    }
+    
+    // Ticks of earlier runs are replayed, new ones appended
+    if (journalPath)
+    {
+        if (g_Journal.open(journalPath, g_Pipeline.getPriceScale().tickSize, TickJournal::Config(), replayJournal, &g_Pipeline))
+        {
+            g_Pipeline.setTickRecorder(&g_Journal);
+            printf("Recovered %lld ticks from %s\n", (long long)g_Journal.getRecoveredTicks(), journalPath);
+        }
+        else
+        {
+            fprintf(stderr, "Cannot open journal %s\n", journalPath);
+        }
+    }
+    
+    // Column file of another instance (--export), ending where live data starts
+    if (loadPath)
+    {
+        TimeNs intervalNs = secondsToNs(ChartRenderer::INTERVALS[g_ChartRenderer.getSettings().selectedInterval]);
+        BackfillBatch* batch = readColumnBatch(loadPath, 0, intervalNs, g_Pipeline.getPriceScale().tickSize);
+        if (batch)
+            g_Pipeline.backfill(batch);
+        else
+            fprintf(stderr, "Cannot load %s\n", loadPath);
+    }
+#endif
+    if (archivePath && g_Archive.open(archivePath))
+        g_ChartRenderer.setArchive(&g_Archive);
+    
+    // Stores start at their default sizes; caps over budget are applied
+    // before the worker starts
+#ifdef __EMSCRIPTEN__
+#ifdef FIXED_HEAP_MB
+    size_t memoryBudgetMB = FIXED_HEAP_MB > HEAP_RESERVE_MB ? FIXED_HEAP_MB - HEAP_RESERVE_MB : 1;
+#else
+    size_t memoryBudgetMB = MEMORY_BUDGET_MB;
+#endif
+#endif
+    g_Archive.registerMemory(g_Memory);
+    g_Pipeline.registerMemory(g_Memory);
+    g_Memory.setBudget(memoryBudgetMB << 20);
+    g_Memory.update();
+    
+    // Generate data on a worker thread when available (native, WASM -pthread)
+    if (g_Pipeline.startWorker())
+        printf("Data pipeline running on a worker thread\n");
+    
+    // Background work on job workers when available, otherwise on the
+    // render thread after each frame
+#if JOB_SYSTEM_THREADS
+    unsigned int cores = std::thread::hardware_concurrency();
+    int jobWorkers = cores > 2 ? (int)cores - 2 : 1;
+    if (jobWorkers > MAX_JOB_WORKERS) jobWorkers = MAX_JOB_WORKERS;
+    if (g_Jobs.start(jobWorkers) > 0)
+        printf("Job system running %d workers\n", jobWorkers);
+#endif
+
+    // CSV history parsed by jobs, streamed in chunks (in WASM fetched from
+    // the server when present)
+    CsvImporter::Config importConfig;
+    importConfig.tickSize = g_Pipeline.getPriceScale().tickSize;
+    g_ImportPending = importPath && g_Importer.open(importPath, importConfig);
+    if (g_ImportPending)
+        queueImportJob();
+    
+    // Start main loop (Emscripten drives it from requestAnimationFrame,
+    // native runs until the window is closed)
+    platformRunMainLoop(main_loop);
     
     // Cleanup (won't be reached in Emscripten, but good practice)
+    g_Jobs.stop();
+    g_Pipeline.stopWorker();
+#ifndef __EMSCRIPTEN__
+    g_Journal.close();
+    if (exportPath && !g_Pipeline.exportData(exportPath, compressExport))
+        fprintf(stderr, "Cannot export %s\n", exportPath);
+#endif
     shutdown();
     
     return 0;
@@ -0,0 +1,97 @@
+#include "draw_stats.h"
+#include <math.h>
+
+static bool sameTexture(const ImTextureRef& a, const ImTextureRef& b)
+{
+    return a._TexData == b._TexData && a._TexID == b._TexID;
+}
+
+static bool sameClipRect(const ImVec4& a, const ImVec4& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+void analyzeDrawListFill(const ImDrawList* drawList, ImVec2 framebufferScale, DrawListFill& out)
+{
+    out = {};
+    out.name = drawList->_OwnerName;
+    
+    const ImDrawVert* vtx = drawList->VtxBuffer.Data;
+    const ImDrawIdx* idx = drawList->IdxBuffer.Data;
+    float pixelScale = framebufferScale.x * framebufferScale.y;
+    
+    ImVec4 bounds(0, 0, 0, 0);
+    bool hasBounds = false;
+    const ImDrawCmd* prev = nullptr;    // Last command drawn (callbacks and empty ones skipped)
+    
+    for (int c = 0; c < drawList->CmdBuffer.Size; c++)
+    {
+        const ImDrawCmd& cmd = drawList->CmdBuffer[c];
+        if (cmd.UserCallback != nullptr || cmd.ElemCount == 0)
+            continue;
+        
+        // State changes relative to the previous drawn command
+        if (prev)
+        {
+            if (!sameTexture(cmd.TexRef, prev->TexRef)) out.textureChanges++;
+            if (!sameClipRect(cmd.ClipRect, prev->ClipRect)) out.clipRectChanges++;
+        }
+        prev = &cmd;
+        
+        const ImVec4& clip = cmd.ClipRect;
+        if (clip.z <= clip.x || clip.w <= clip.y)
+            continue;
+        
+        if (!hasBounds)
+        {
+            bounds = clip;
+            hasBounds = true;
+        }
+        else
+        {
+            if (clip.x < bounds.x) bounds.x = clip.x;
+            if (clip.y < bounds.y) bounds.y = clip.y;
+            if (clip.z > bounds.z) bounds.z = clip.z;
+            if (clip.w > bounds.w) bounds.w = clip.w;
+        }
+        
+        const ImDrawIdx* cmdIdx = idx + cmd.IdxOffset;
+        const ImDrawVert* cmdVtx = vtx + cmd.VtxOffset;
+        
+        for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3)
+        {
+            ImVec2 a = cmdVtx[cmdIdx[i]].pos;
+            ImVec2 b = cmdVtx[cmdIdx[i + 1]].pos;
+            ImVec2 p = cmdVtx[cmdIdx[i + 2]].pos;
+            out.triangles++;
+            
+            float area = 0.5f * fabsf((b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y));
+            if (area <= 0.0f)
+                continue;
+            
+            // Bounding box of the triangle
+            float minX = fminf(a.x, fminf(b.x, p.x));
+            float minY = fminf(a.y, fminf(b.y, p.y));
+            float maxX = fmaxf(a.x, fmaxf(b.x, p.x));
+            float maxY = fmaxf(a.y, fmaxf(b.y, p.y));
+            
+            // Fraction of the bounding box inside the clip rect
+            float ix = fminf(maxX, clip.z) - fmaxf(minX, clip.x);
+            float iy = fminf(maxY, clip.w) - fmaxf(minY, clip.y);
+            if (ix <= 0.0f || iy <= 0.0f)
+                continue;
+            
+            float boxArea = (maxX - minX) * (maxY - minY);
+            float visible = (boxArea > 0.0f) ? (ix * iy) / boxArea : 1.0f;
+            if (visible > 1.0f) visible = 1.0f;
+            
+            out.coveredPixels += (double)(area * visible * pixelScale);
+        }
+    }
+    
+    if (hasBounds)
+    {
+        out.boundsPixels = (double)((bounds.z - bounds.x) * (bounds.w - bounds.y) * pixelScale);
+        out.overdraw = out.boundsPixels > 0.0 ? (float)(out.coveredPixels / out.boundsPixels) : 0.0f;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "imgui.h"
+
+// ============================================================================
+// DRAW STATS
+// CPU-side fill cost estimation from ImGui draw lists
+// Works on plain ImDrawList data, so it runs headless without a GPU
+// ============================================================================
+
+struct DrawListFill
+{
+    const char* name;       // Owner window name (may be null)
+    int triangles;
+    double coveredPixels;   // Sum of triangle areas inside clip rects (framebuffer px)
+    double boundsPixels;    // Area of the union bounding box of all clip rects
+    float overdraw;         // coveredPixels / boundsPixels
+    int textureChanges;     // Texture switches between consecutive commands
+    int clipRectChanges;    // Scissor switches between consecutive commands
+};
+
+// Estimate covered pixels, overdraw and state changes for one draw list.
+// Triangles are clipped by scaling their area with the fraction of their
+// bounding box inside the command's clip rect (exact for axis-aligned quads).
+void analyzeDrawListFill(const ImDrawList* drawList, ImVec2 framebufferScale, DrawListFill& out);
+
+// Geometry emitted by one logical component of a window (e.g. chart grid)
+struct DrawComponentStats
+{
+    const char* name;
+    int vertices;
+    int indices;
+    int commands;
+};
+
+// Samples draw list buffer sizes around a block of drawing calls and
+// accumulates the growth into a DrawComponentStats
+struct DrawListSample
+{
+    const ImDrawList* drawList;
+    int vtxStart;
+    int idxStart;
+    int cmdStart;
+    
+    explicit DrawListSample(const ImDrawList* list)
+        : drawList(list)
+        , vtxStart(list->VtxBuffer.Size)
+        , idxStart(list->IdxBuffer.Size)
+        , cmdStart(list->CmdBuffer.Size)
+    {}
+    
+    void end(DrawComponentStats& out) const
+    {
+        out.vertices += drawList->VtxBuffer.Size - vtxStart;
+        out.indices += drawList->IdxBuffer.Size - idxStart;
+        out.commands += drawList->CmdBuffer.Size - cmdStart;
+    }
+};
@@ -0,0 +1,82 @@
+#include "latency_tracker.h"
+#include <algorithm>
+#include <string.h>
+
+LatencyTracker::LatencyTracker()
+    : m_pendingCount(0)
+    , m_stride(1)
+    , m_strideCounter(0)
+    , m_sampleHead(0)
+    , m_sampleCount(0)
+    , m_presentsSinceUpdate(0)
+{
+    m_stats = {};
+    
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_p50 = metrics.gauge("latency.p50_ms");
+    m_p99 = metrics.gauge("latency.p99_ms");
+    m_subsampled = metrics.counter("latency.subsampled");
+}
+
+void LatencyTracker::onTickVisible(double ingestTimeMs)
+{
+    if (++m_strideCounter < m_stride)
+        return;
+    m_strideCounter = 0;
+    
+    if (m_pendingCount == MAX_PENDING)
+    {
+        // Keep every other sample and halve the sampling rate from here on
+        for (int i = 0; i < MAX_PENDING / 2; i++)
+        {
+            m_pending[i] = m_pending[i * 2];
+        }
+        m_pendingCount = MAX_PENDING / 2;
+        m_stride *= 2;
+        m_subsampled->add();
+    }
+    
+    m_pending[m_pendingCount++] = ingestTimeMs;
+}
+
+void LatencyTracker::onPresent(double presentTimeMs)
+{
+    for (int i = 0; i < m_pendingCount; i++)
+    {
+        float latencyMs = (float)(presentTimeMs - m_pending[i]);
+        if (latencyMs < 0.0f) latencyMs = 0.0f;
+        
+        m_samples[m_sampleHead] = latencyMs;
+        m_sampleHead = (m_sampleHead + 1) % WINDOW_SIZE;
+        if (m_sampleCount < WINDOW_SIZE) m_sampleCount++;
+    }
+    
+    m_pendingCount = 0;
+    m_stride = 1;
+    m_strideCounter = 0;
+    
+    if (++m_presentsSinceUpdate >= UPDATE_INTERVAL)
+    {
+        updatePercentiles();
+        m_presentsSinceUpdate = 0;
+    }
+}
+
+void LatencyTracker::updatePercentiles()
+{
+    if (m_sampleCount == 0)
+        return;
+    
+    memcpy(m_sorted, m_samples, sizeof(float) * m_sampleCount);
+    std::sort(m_sorted, m_sorted + m_sampleCount);
+    
+    int last = m_sampleCount - 1;
+    m_stats.p50 = m_sorted[last * 50 / 100];
+    m_stats.p90 = m_sorted[last * 90 / 100];
+    m_stats.p99 = m_sorted[last * 99 / 100];
+    m_stats.max = m_sorted[last];
+    m_stats.samples = m_sampleCount;
+    
+    m_p50->set(m_stats.p50);
+    m_p99->set(m_stats.p99);
+}
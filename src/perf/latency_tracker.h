@@ -0,0 +1,71 @@
+#pragma once
+
+#include "metrics.h"
+
+// ============================================================================
+// LATENCY TRACKER
+// Tick-to-screen latency: time from a tick's ingest stamp to the swap of the
+// first frame that renders it. Producers stamp each tick when it enters the
+// process (StampedTick::ingestTime, carried beside the tick until it is
+// applied); whoever applies ticks to renderable state reports them here on
+// the render thread.
+// ============================================================================
+
+// Receives the ingest stamp of every tick applied to renderable state.
+// Implemented by LatencyTracker (inline pipeline) and by DataPipeline, which
+// forwards stamps from its worker thread with each published snapshot.
+class TickStampSink
+{
+public:
+    virtual ~TickStampSink() {}
+    virtual void onTickVisible(double ingestTimeMs) = 0;
+};
+
+struct LatencyStats
+{
+    float p50;
+    float p90;
+    float p99;
+    float max;
+    int samples;    // Samples in the rolling window
+};
+
+class LatencyTracker : public TickStampSink
+{
+public:
+    static const int MAX_PENDING = 1024;      // Ticks awaiting present
+    static const int WINDOW_SIZE = 2048;      // Rolling window for percentiles
+    static const int UPDATE_INTERVAL = 30;    // Presents between percentile updates
+    
+    LatencyTracker();
+    
+    // A tick with the given ingest stamp is now part of renderable state
+    void onTickVisible(double ingestTimeMs) override;
+    
+    // The frame holding all visible ticks was presented (call after swap)
+    void onPresent(double presentTimeMs);
+    
+    const LatencyStats& getStats() const { return m_stats; }
+    
+private:
+    // Ticks made visible since last present. When more arrive than fit,
+    // the buffer is halved and sampling stride doubled (uniform subsample).
+    double m_pending[MAX_PENDING];
+    int m_pendingCount;
+    int m_stride;
+    int m_strideCounter;
+    
+    // Rolling sample window (ring buffer)
+    float m_samples[WINDOW_SIZE];
+    float m_sorted[WINDOW_SIZE];
+    int m_sampleHead;
+    int m_sampleCount;
+    int m_presentsSinceUpdate;
+    
+    LatencyStats m_stats;
+    Metric* m_p50;
+    Metric* m_p99;
+    Metric* m_subsampled;
+    
+    void updatePercentiles();
+};
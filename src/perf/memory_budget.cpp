@@ -0,0 +1,95 @@
+#include "memory_budget.h"
+
+const char* const MemoryBudget::VALUE_NAMES[MEMORY_VALUE_COUNT] = { "cache", "detail", "series", "history" };
+
+MemoryBudget::MemoryBudget()
+    : m_storeCount(0)
+    , m_budget(0)
+    , m_used(0)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_budgetBytes = metrics.gauge("memory.budget_bytes");
+    m_usedBytes = metrics.gauge("memory.used_bytes");
+    m_shrinks = metrics.counter("memory.shrinks");
+}
+
+void MemoryBudget::setBudget(size_t bytes)
+{
+    bool raised = bytes == 0 || (m_budget != 0 && bytes > m_budget);
+    m_budget = bytes;
+    m_budgetBytes->set((double)bytes);
+    if (!raised)
+        return;
+    
+    for (int i = 0; i < m_storeCount; i++)
+    {
+        Store& store = m_stores[i];
+        if (store.limitBytes == UNLIMITED)
+            continue;
+        store.limitBytes = UNLIMITED;
+        store.limit(store.user, UNLIMITED);
+    }
+}
+
+bool MemoryBudget::add(const char* name, MemoryValue value, size_t floorBytes,
+                       MemoryUsageFn usage, MemoryLimitFn limit, void* user)
+{
+    if (m_storeCount == MAX_STORES)
+        return false;
+    
+    Store& store = m_stores[m_storeCount];
+    store.name = name;
+    store.value = value;
+    store.floorBytes = floorBytes;
+    store.usedBytes = usage(user);
+    store.limitBytes = UNLIMITED;
+    store.usage = usage;
+    store.limit = limit;
+    store.user = user;
+    
+    // Keep the shrink order sorted by value, stable for equal values
+    int slot = m_storeCount;
+    while (slot > 0 && m_stores[m_order[slot - 1]].value > value)
+    {
+        m_order[slot] = m_order[slot - 1];
+        slot--;
+    }
+    m_order[slot] = m_storeCount;
+    m_storeCount++;
+    return true;
+}
+
+void MemoryBudget::update()
+{
+    // A store applies its cap on its own schedule; until then it counts as
+    // holding no more than the cap
+    size_t total = 0;
+    for (int i = 0; i < m_storeCount; i++)
+    {
+        Store& store = m_stores[i];
+        store.usedBytes = store.usage(store.user);
+        total += store.usedBytes < store.limitBytes ? store.usedBytes : store.limitBytes;
+    }
+    
+    if (m_budget > 0 && total > m_budget)
+    {
+        size_t excess = total - m_budget;
+        for (int i = 0; i < m_storeCount && excess > 0; i++)
+        {
+            Store& store = m_stores[m_order[i]];
+            size_t held = store.usedBytes < store.limitBytes ? store.usedBytes : store.limitBytes;
+            if (held <= store.floorBytes)
+                continue;
+            
+            size_t cut = held - store.floorBytes < excess ? held - store.floorBytes : excess;
+            store.limitBytes = held - cut;
+            store.limit(store.user, store.limitBytes);
+            m_shrinks->add();
+            excess -= cut;
+            total -= cut;
+        }
+    }
+    
+    m_used = total;
+    m_usedBytes->set((double)total);
+}
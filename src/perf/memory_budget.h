@@ -0,0 +1,89 @@
+#pragma once
+
+#include "metrics.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// MEMORY BUDGET
+// One byte budget shared by the large data stores and caches (tiered
+// history, candle series, archive block cache). Each store registers how to
+// read the bytes it holds and how to resize itself, with a value class and a
+// floor. When the total exceeds the budget, stores are capped in order of
+// value, least valuable first (reloadable caches, then fine history that
+// coarser tiers still summarize, then data that would be lost for good),
+// each down to its floor at most, until the total fits. Caps are applied by
+// the stores themselves, possibly on their own thread a step later.
+//
+// Stores allocate their default size up front and never grow past a cap, so
+// under a budget the heap stops growing once the caps are in place. With a
+// fixed heap (WASM built with FIXED_HEAP_MB, no ALLOW_MEMORY_GROWTH) the
+// budget is what is left of the heap after a reserve for everything else.
+// ============================================================================
+
+// Bytes a store currently holds (any thread's view, read once per update)
+typedef size_t (*MemoryUsageFn)(void* user);
+
+// Cap a store at limitBytes (MemoryBudget::UNLIMITED: back to its default)
+typedef void (*MemoryLimitFn)(void* user, size_t limitBytes);
+
+// Value classes, least valuable first; equal classes shrink in the order
+// the stores were added
+enum MemoryValue
+{
+    MEMORY_CACHE,       // Reloadable (archive blocks)
+    MEMORY_DETAIL,      // Fine history a coarser store still summarizes
+    MEMORY_SERIES,      // Displayed candles
+    MEMORY_HISTORY,     // Lost for good when dropped
+    MEMORY_VALUE_COUNT
+};
+
+class MemoryBudget
+{
+public:
+    static const int MAX_STORES = 16;
+    static const size_t UNLIMITED = SIZE_MAX;
+    static const char* const VALUE_NAMES[MEMORY_VALUE_COUNT];
+    
+    struct Store
+    {
+        const char* name;
+        MemoryValue value;
+        size_t floorBytes;      // Never capped below this
+        size_t usedBytes;       // As of the last update()
+        size_t limitBytes;      // Current cap (UNLIMITED = none)
+        MemoryUsageFn usage;
+        MemoryLimitFn limit;
+        void* user;
+    };
+    
+    MemoryBudget();
+    
+    // Total bytes for all stores (0 = no budget). Raising it lifts every cap;
+    // the next update() caps again what still does not fit.
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return m_budget; }
+    
+    // Register a store (returns false when MAX_STORES are registered)
+    bool add(const char* name, MemoryValue value, size_t floorBytes,
+             MemoryUsageFn usage, MemoryLimitFn limit, void* user);
+    
+    // Call once per frame: read usage and cap stores while over budget
+    void update();
+    
+    size_t getUsedBytes() const { return m_used; }
+    int getStoreCount() const { return m_storeCount; }
+    const Store& getStore(int index) const { return m_stores[index]; }
+    
+private:
+    Store m_stores[MAX_STORES];
+    int m_order[MAX_STORES];    // Store indices, least valuable first
+    int m_storeCount;
+    size_t m_budget;
+    size_t m_used;
+    
+    // Metrics (owned by MetricsRegistry)
+    Metric* m_budgetBytes;
+    Metric* m_usedBytes;
+    Metric* m_shrinks;
+};
@@ -0,0 +1,68 @@
+#include "metrics.h"
+#include <string.h>
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : m_count(0)
+    , m_rateTimer(0.0f)
+{
+    m_overflow.m_name = "(overflow)";
+}
+
+Metric* MetricsRegistry::registerMetric(const char* name, MetricType type)
+{
+    int count = m_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(m_metrics[i].m_name, name) == 0)
+            return &m_metrics[i];
+    }
+    
+    if (count >= MAX_METRICS)
+        return &m_overflow;
+    
+    Metric& metric = m_metrics[count];
+    metric.m_name = name;
+    metric.m_type = type;
+    
+    // Publish after the slot is filled so readers never see a half-built entry
+    m_count.store(count + 1, std::memory_order_release);
+    return &metric;
+}
+
+const Metric* MetricsRegistry::find(const char* name) const
+{
+    int count = this->count();
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(m_metrics[i].m_name, name) == 0)
+            return &m_metrics[i];
+    }
+    return nullptr;
+}
+
+void MetricsRegistry::updateRates(float deltaTime)
+{
+    m_rateTimer += deltaTime;
+    if (m_rateTimer < RATE_WINDOW)
+        return;
+    
+    int count = this->count();
+    for (int i = 0; i < count; i++)
+    {
+        Metric& metric = m_metrics[i];
+        if (metric.m_type == METRIC_GAUGE)
+            continue;
+        
+        int64_t value = metric.value();
+        metric.m_rate.store((float)(value - metric.m_lastValue) / m_rateTimer, std::memory_order_relaxed);
+        metric.m_lastValue = value;
+    }
+    
+    m_rateTimer = 0.0f;
+}
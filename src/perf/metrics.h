@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// ============================================================================
+// METRICS REGISTRY
+// Named counters, gauges and rate meters shared by all modules
+// Hot paths update through a cached Metric* with relaxed atomics (no locks)
+// ============================================================================
+
+enum MetricType
+{
+    METRIC_COUNTER,   // Monotonic total (e.g. candles finalized)
+    METRIC_GAUGE,     // Last written value (e.g. candles in buffer)
+    METRIC_RATE       // Monotonic total, displayed as events per second
+};
+
+class Metric
+{
+public:
+    Metric() : m_name(nullptr), m_type(METRIC_COUNTER), m_value(0), m_gauge(0.0), m_rate(0.0f), m_lastValue(0) {}
+    
+    // Counters and rate meters
+    void add(int64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+    
+    // Gauges
+    void set(double v) { m_gauge.store(v, std::memory_order_relaxed); }
+    double gauge() const { return m_gauge.load(std::memory_order_relaxed); }
+    
+    // Events per second over the last rate window (counters and rate meters)
+    float rate() const { return m_rate.load(std::memory_order_relaxed); }
+    
+    const char* name() const { return m_name; }
+    MetricType type() const { return m_type; }
+    
+private:
+    friend class MetricsRegistry;
+    
+    const char* m_name;
+    MetricType m_type;
+    std::atomic<int64_t> m_value;
+    std::atomic<double> m_gauge;
+    std::atomic<float> m_rate;
+    int64_t m_lastValue;   // Value at start of current rate window
+};
+
+class MetricsRegistry
+{
+public:
+    static const int MAX_METRICS = 96;
+    static constexpr float RATE_WINDOW = 1.0f;  // Seconds between rate updates
+    
+    static MetricsRegistry& instance();
+    
+    // Registration (call at setup, not per frame). Returns the existing
+    // metric when the name is already registered. Names must be string
+    // literals or otherwise outlive the registry.
+    Metric* counter(const char* name) { return registerMetric(name, METRIC_COUNTER); }
+    Metric* gauge(const char* name) { return registerMetric(name, METRIC_GAUGE); }
+    Metric* rate(const char* name) { return registerMetric(name, METRIC_RATE); }
+    
+    // Enumeration for display and exporters
+    int count() const { return m_count.load(std::memory_order_acquire); }
+    const Metric& get(int index) const { return m_metrics[index]; }
+    const Metric* find(const char* name) const;
+    
+    // Recompute per-second rates (call once per frame from the render thread)
+    void updateRates(float deltaTime);
+    
+private:
+    MetricsRegistry();
+    
+    Metric m_metrics[MAX_METRICS];
+    Metric m_overflow;   // Returned when the registry is full
+    std::atomic<int> m_count;
+    float m_rateTimer;
+    
+    Metric* registerMetric(const char* name, MetricType type);
+};
@@ -1,12 +1,42 @@
 #include "perf_monitor.h"
 #include <math.h>
-#include <emscripten/heap.h>
+#include "../platform/platform.h"
+#include "../data/tick_policy.h"
+
+const char* const PerfMonitor::ZONE_NAMES[ZONE_COUNT] = {
+    "Data", "Events", "Chart", "PerfUI", "Render", "Present", "Jobs"
+};
 
 PerfMonitor::PerfMonitor()
     : m_frameTimeSum(0.0f)
     , m_frameTimeHistoryIdx(0)
     , m_initialized(false)
+    , m_showDrawLists(false)
+    , m_frameStartMs(0.0)
+    , m_zoneStartMs(0.0)
+    , m_frameIndex(0)
+    , m_ticksAtFrameStart(0)
+    , m_spikeThresholdMs(20.0f)
+    , m_spikeLogHead(0)
+    , m_spikeLogCount(0)
+    , m_showSpikeLog(false)
 {
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_framesSkipped = metrics.counter("frames.skipped");
+    m_ticksIngested = metrics.rate("ticks.ingested");
+    m_candleCount = metrics.gauge("candles.count");
+    m_memoryUsed = metrics.gauge("memory.used_bytes");
+    m_memoryBudget = metrics.gauge("memory.budget_bytes");
+    m_tickPolicy = metrics.gauge("ticks.policy");
+    m_tickPolicyWindow = metrics.gauge("ticks.policy_window_ms");
+    m_ticksConflated = metrics.counter("ticks.conflated");
+    m_ticksDropped = metrics.counter("ticks.dropped");
+    m_coveredPixels = metrics.gauge("draw.covered_px");
+    m_overdraw = metrics.gauge("draw.overdraw");
+    m_textureChanges = metrics.gauge("draw.texture_changes");
+    m_clipRectChanges = metrics.gauge("draw.clip_changes");
+    
+    m_frame = {};
     m_stats = {};
     m_stats.frameTimeMin = 1000.0f;
     m_stats.frameTimeMax = 0.0f;
@@ -21,11 +51,19 @@ void PerfMonitor::beginFrame(float deltaTime)
 {
     m_initialized = true;
     
+    // Close out the previous frame (logging it if slow) and start timing this one
+    checkSpike(platformNowMs());
+    
+    MetricsRegistry::instance().updateRates(deltaTime);
+    
     float frameTimeMs = deltaTime * 1000.0f;
     
     // Sanity check
     if (frameTimeMs <= 0.0f || frameTimeMs >= 1000.0f)
+    {
+        m_framesSkipped->add();
         return;
+    }
     
     // Update min/max
     if (frameTimeMs < m_stats.frameTimeMin) m_stats.frameTimeMin = frameTimeMs;
@@ -35,9 +73,6 @@ void PerfMonitor::beginFrame(float deltaTime)
     m_frameTimeSum += frameTimeMs;
     m_stats.frameTimeSamples++;
     
-    // Track spikes (>20ms would typically be GC pause in JS/React)
-    if (frameTimeMs > 20.0f) m_stats.frameSpikes++;
-    
     // Rolling history for jitter calculation
     m_frameTimeHistory[m_frameTimeHistoryIdx] = frameTimeMs;
     m_frameTimeHistoryIdx = (m_frameTimeHistoryIdx + 1) % HISTORY_SIZE;
@@ -54,7 +89,7 @@ void PerfMonitor::beginFrame(float deltaTime)
     updateJitter();
     
     // Update memory stats
-    m_stats.heapSizeBytes = emscripten_get_heap_size();
+    m_stats.heapSizeBytes = platformHeapSize();
     m_stats.heapSizeMB = (float)m_stats.heapSizeBytes / (1024.0f * 1024.0f);
 }
 
@@ -64,10 +99,34 @@ void PerfMonitor::endFrame(ImDrawData* drawData)
     {
         m_stats.drawLists = drawData->CmdListsCount;
         m_stats.drawCalls = 0;
+        m_stats.coveredPixels = 0.0;
+        m_stats.textureChanges = 0;
+        m_stats.clipRectChanges = 0;
+        m_stats.drawListFillCount = 0;
+        
         for (int i = 0; i < drawData->CmdListsCount; i++)
         {
-            m_stats.drawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+            const ImDrawList* drawList = drawData->CmdLists[i];
+            m_stats.drawCalls += drawList->CmdBuffer.Size;
+            
+            DrawListFill fill;
+            analyzeDrawListFill(drawList, drawData->FramebufferScale, fill);
+            m_stats.coveredPixels += fill.coveredPixels;
+            m_stats.textureChanges += fill.textureChanges;
+            m_stats.clipRectChanges += fill.clipRectChanges;
+            
+            if (m_stats.drawListFillCount < PerfStats::MAX_DRAW_LISTS)
+                m_stats.drawListFill[m_stats.drawListFillCount++] = fill;
         }
+        
+        double framebufferPixels = (double)(drawData->DisplaySize.x * drawData->FramebufferScale.x) *
+                                   (double)(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+        m_stats.overdraw = framebufferPixels > 0.0 ? (float)(m_stats.coveredPixels / framebufferPixels) : 0.0f;
+        
+        m_coveredPixels->set(m_stats.coveredPixels);
+        m_overdraw->set(m_stats.overdraw);
+        m_textureChanges->set(m_stats.textureChanges);
+        m_clipRectChanges->set(m_stats.clipRectChanges);
     }
     
     // Get render stats from ImGui
@@ -75,6 +134,70 @@ void PerfMonitor::endFrame(ImDrawData* drawData)
     m_stats.vertices = io.MetricsRenderVertices;
     m_stats.indices = io.MetricsRenderIndices;
     m_stats.triangles = m_stats.indices / 3;
+    
+    m_frame.vertices = m_stats.vertices;
+}
+
+void PerfMonitor::setComponentStats(const DrawComponentStats* stats, int count)
+{
+    if (count > PerfStats::MAX_COMPONENTS) count = PerfStats::MAX_COMPONENTS;
+    for (int i = 0; i < count; i++)
+    {
+        m_stats.components[i] = stats[i];
+    }
+    m_stats.componentCount = count;
+}
+
+void PerfMonitor::onPresent()
+{
+    m_latency.onPresent(platformNowMs());
+}
+
+void PerfMonitor::beginZone(PerfZone zone)
+{
+    (void)zone;
+    m_zoneStartMs = platformNowMs();
+}
+
+void PerfMonitor::endZone(PerfZone zone)
+{
+    m_frame.zoneMs[zone] += (float)(platformNowMs() - m_zoneStartMs);
+}
+
+void PerfMonitor::checkSpike(double nowMs)
+{
+    // The interval since the last beginFrame covers the whole previous frame,
+    // including present. Spikes (>20ms would typically be GC pause in JS/React)
+    // are logged with that frame's zone breakdown.
+    if (m_frameStartMs > 0.0)
+    {
+        float intervalMs = (float)(nowMs - m_frameStartMs);
+        
+        // Same sanity bound as beginFrame (ignore paused/background tabs)
+        if (intervalMs > m_spikeThresholdMs && intervalMs < 1000.0f)
+        {
+            m_frame.frameTimeMs = intervalMs;
+            m_frame.ticks = (int)(m_ticksIngested->value() - m_ticksAtFrameStart);
+            m_frame.candles = (int)m_candleCount->gauge();
+            
+            m_spikeLog[m_spikeLogHead] = m_frame;
+            m_spikeLogHead = (m_spikeLogHead + 1) % SPIKE_LOG_SIZE;
+            if (m_spikeLogCount < SPIKE_LOG_SIZE) m_spikeLogCount++;
+            
+            m_stats.frameSpikes++;
+        }
+    }
+    
+    m_frame = {};
+    m_frame.frame = ++m_frameIndex;
+    m_frameStartMs = nowMs;
+    m_ticksAtFrameStart = m_ticksIngested->value();
+}
+
+const SpikeRecord& PerfMonitor::getSpike(int index) const
+{
+    int actualIndex = (m_spikeLogHead - 1 - index + SPIKE_LOG_SIZE) % SPIKE_LOG_SIZE;
+    return m_spikeLog[actualIndex];
 }
 
 void PerfMonitor::updateJitter()
@@ -88,8 +211,7 @@ void PerfMonitor::updateJitter()
     m_stats.frameTimeJitter = sqrtf(jitterSum / HISTORY_SIZE);
 }
 
-void PerfMonitor::renderWindow(float windowPosY, float windowHeight, float windowWidth,
-                                float ticksPerSecond, int candleCount, int maxCandles)
+void PerfMonitor::renderWindow(float windowPosY, float windowHeight, float windowWidth)
 {
     ImGuiIO& io = ImGui::GetIO();
     
@@ -107,6 +229,29 @@ void PerfMonitor::renderWindow(float windowPosY, float windowHeight, float windo
     ImGui::Text("Frame: %.2f ms", frameMs);
     float budgetUsage = (frameMs / 16.667f) * 100.0f;
     ImGui::Text("Budget: %.1f%%", budgetUsage);
+    const LatencyStats& latency = m_latency.getStats();
+    ImGui::Text("Tick->px: %.1f/%.1f ms", latency.p50, latency.p99);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Tick-to-screen latency (%d samples)", latency.samples);
+        ImGui::Text("p50: %.2f ms  p90: %.2f ms", latency.p50, latency.p90);
+        ImGui::Text("p99: %.2f ms  max: %.2f ms", latency.p99, latency.max);
+        ImGui::EndTooltip();
+    }
+    
+    // Overload policy between the feed and the candles
+    int policy = (int)m_tickPolicy->gauge();
+    if (policy == TICK_KEEP_ALL)
+        ImGui::Text("Ticks: %s", tickPolicyName(policy));
+    else
+        ImGui::Text("Ticks: %s %.0f ms", tickPolicyName(policy), m_tickPolicyWindow->gauge());
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Conflated: %lld  Dropped: %lld", (long long)m_ticksConflated->value(), (long long)m_ticksDropped->value());
+        ImGui::EndTooltip();
+    }
     
     ImGui::NextColumn();
     
@@ -124,6 +269,7 @@ void PerfMonitor::renderWindow(float windowPosY, float windowHeight, float windo
     else
         ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "Spikes: %.2f%%", m_stats.spikeRate);
     ImGui::Text("Samples: %d", m_stats.frameTimeSamples);
+    if (ImGui::SmallButton("Spike Log")) m_showSpikeLog = !m_showSpikeLog;
     
     ImGui::NextColumn();
     
@@ -131,21 +277,195 @@ void PerfMonitor::renderWindow(float windowPosY, float windowHeight, float windo
     ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Render Stats");
     ImGui::Text("Triangles: %d", m_stats.triangles);
     ImGui::Text("Draw Calls: %d", m_stats.drawCalls);
+    ImGui::Text("Overdraw: %.2fx", m_stats.overdraw);
+    if (ImGui::SmallButton("Draw Lists")) m_showDrawLists = !m_showDrawLists;
     
     ImGui::NextColumn();
     
     // Column 5: Memory (WASM has predictable memory, no GC churn)
     ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Memory");
     ImGui::Text("Heap: %.1f MB", m_stats.heapSizeMB);
+    if (m_memoryBudget->gauge() > 0.0)
+        ImGui::Text("Budget: %.1f / %.0f MB", m_memoryUsed->gauge() / 1048576.0, m_memoryBudget->gauge() / 1048576.0);
     ImGui::Text("Verts: %d", m_stats.vertices);
     
     ImGui::NextColumn();
     
-    // Column 6: Update stats
-    ImGui::Text("Ticks/s: %.0f", ticksPerSecond);
-    ImGui::Text("Candles: %d/%d", candleCount, maxCandles);
+    // Column 6: Registered metrics
     ImGui::Text("Frames: %d", ImGui::GetFrameCount());
+    renderMetrics();
     
     ImGui::Columns(1);
     ImGui::End();
+    
+    if (m_showSpikeLog)
+        renderSpikeLog();
+    if (m_showDrawLists)
+        renderDrawLists();
+}
+
+void PerfMonitor::renderDrawLists()
+{
+    ImGui::SetNextWindowSize(ImVec2(560, 240), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Draw Lists", &m_showDrawLists))
+    {
+        ImGui::End();
+        return;
+    }
+    
+    ImGui::Text("Covered: %.0f px  Overdraw: %.2fx  Tex changes: %d  Clip changes: %d",
+                m_stats.coveredPixels, m_stats.overdraw, m_stats.textureChanges, m_stats.clipRectChanges);
+    
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    ImVec2 tableSize(0, ImGui::GetTextLineHeightWithSpacing() * 8);
+    if (ImGui::BeginTable("drawlists", 6, flags, tableSize))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Window");
+        ImGui::TableSetupColumn("Tris");
+        ImGui::TableSetupColumn("Covered px");
+        ImGui::TableSetupColumn("Overdraw");
+        ImGui::TableSetupColumn("Tex");
+        ImGui::TableSetupColumn("Clip");
+        ImGui::TableHeadersRow();
+        
+        for (int i = 0; i < m_stats.drawListFillCount; i++)
+        {
+            const DrawListFill& fill = m_stats.drawListFill[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(fill.name ? fill.name : "(unnamed)");
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", fill.triangles);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", fill.coveredPixels);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2fx", fill.overdraw);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", fill.textureChanges);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", fill.clipRectChanges);
+        }
+        ImGui::EndTable();
+    }
+    
+    if (m_stats.componentCount > 0)
+    {
+        ImGui::Separator();
+        ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Components");
+        if (ImGui::BeginTable("components", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Component");
+            ImGui::TableSetupColumn("Verts");
+            ImGui::TableSetupColumn("Indices");
+            ImGui::TableSetupColumn("Cmds");
+            ImGui::TableHeadersRow();
+            
+            for (int i = 0; i < m_stats.componentCount; i++)
+            {
+                const DrawComponentStats& component = m_stats.components[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(component.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", component.vertices);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", component.indices);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", component.commands);
+            }
+            ImGui::EndTable();
+        }
+    }
+    
+    ImGui::End();
+}
+
+void PerfMonitor::renderSpikeLog()
+{
+    ImGui::SetNextWindowSize(ImVec2(640, 300), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Spike Log", &m_showSpikeLog))
+    {
+        ImGui::End();
+        return;
+    }
+    
+    ImGui::SetNextItemWidth(160);
+    ImGui::SliderFloat("Threshold", &m_spikeThresholdMs, 5.0f, 100.0f, "%.1f ms");
+    ImGui::SameLine();
+    ImGui::Text("Logged: %d (last %d kept)", m_stats.frameSpikes, SPIKE_LOG_SIZE);
+    
+    const int columns = 5 + ZONE_COUNT;
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("spikes", columns, flags))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Frame");
+        ImGui::TableSetupColumn("ms");
+        for (int z = 0; z < ZONE_COUNT; z++)
+            ImGui::TableSetupColumn(ZONE_NAMES[z]);
+        ImGui::TableSetupColumn("Ticks");
+        ImGui::TableSetupColumn("Candles");
+        ImGui::TableSetupColumn("Verts");
+        ImGui::TableHeadersRow();
+        
+        for (int i = 0; i < m_spikeLogCount; i++)
+        {
+            const SpikeRecord& spike = getSpike(i);
+            
+            // Highlight the zone that took the most time
+            int culprit = 0;
+            for (int z = 1; z < ZONE_COUNT; z++)
+            {
+                if (spike.zoneMs[z] > spike.zoneMs[culprit]) culprit = z;
+            }
+            
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", spike.frame);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", spike.frameTimeMs);
+            for (int z = 0; z < ZONE_COUNT; z++)
+            {
+                ImGui::TableNextColumn();
+                if (z == culprit)
+                    ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "%.2f", spike.zoneMs[z]);
+                else
+                    ImGui::Text("%.2f", spike.zoneMs[z]);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", spike.ticks);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", spike.candles);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", spike.vertices);
+        }
+        ImGui::EndTable();
+    }
+    
+    ImGui::End();
+}
+
+void PerfMonitor::renderMetrics()
+{
+    const MetricsRegistry& metrics = MetricsRegistry::instance();
+    
+    ImGui::BeginChild("metrics", ImVec2(0, 0), false);
+    for (int i = 0; i < metrics.count(); i++)
+    {
+        const Metric& metric = metrics.get(i);
+        switch (metric.type())
+        {
+        case METRIC_COUNTER:
+            ImGui::Text("%s: %lld", metric.name(), (long long)metric.value());
+            break;
+        case METRIC_GAUGE:
+            ImGui::Text("%s: %.6g", metric.name(), metric.gauge());
+            break;
+        case METRIC_RATE:
+            ImGui::Text("%s: %.0f/s", metric.name(), metric.rate());
+            break;
+        }
+    }
+    ImGui::EndChild();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "imgui.h"
+#include "metrics.h"
+#include "draw_stats.h"
+#include "latency_tracker.h"
 
 // ============================================================================
 // PERFORMANCE MONITOR
@@ -16,7 +19,7 @@ struct PerfStats
     float frameTimeAvg;
     float frameTimeJitter;
     int frameTimeSamples;
-    int frameSpikes;        // Frames > 20ms
+    int frameSpikes;        // Frames over the spike threshold
     float spikeRate;        // Percentage of spiked frames
     
     // Memory
@@ -29,12 +32,54 @@ struct PerfStats
     int drawLists;
     int vertices;
     int indices;
+    
+    // Fill cost (CPU estimate from triangle areas)
+    double coveredPixels;
+    float overdraw;         // Covered pixels / framebuffer pixels
+    int textureChanges;
+    int clipRectChanges;
+    
+    // Per draw list breakdown
+    static const int MAX_DRAW_LISTS = 16;
+    DrawListFill drawListFill[MAX_DRAW_LISTS];
+    int drawListFillCount;
+    
+    // Per component breakdown published by renderers
+    static const int MAX_COMPONENTS = 16;
+    DrawComponentStats components[MAX_COMPONENTS];
+    int componentCount;
+};
+
+// Timed sections of the main loop, used to attribute slow frames
+enum PerfZone
+{
+    ZONE_DATA,          // Interval changes and ticker update
+    ZONE_EVENTS,        // SDL event polling
+    ZONE_CHART,         // Chart window build
+    ZONE_PERF_UI,       // Performance window build
+    ZONE_IMGUI_RENDER,  // ImGui::Render()
+    ZONE_PRESENT,       // GL draw and swap
+    ZONE_JOBS,          // Jobs run on the render thread after present
+    ZONE_COUNT
+};
+
+// Snapshot of one slow frame
+struct SpikeRecord
+{
+    int frame;
+    float frameTimeMs;
+    float zoneMs[ZONE_COUNT];
+    int ticks;      // Ticks ingested during the frame
+    int candles;    // Candles in buffer at end of frame
+    int vertices;
 };
 
 class PerfMonitor
 {
 public:
     static const int HISTORY_SIZE = 60;
+    static const int SPIKE_LOG_SIZE = 32;
+    static const char* const ZONE_NAMES[ZONE_COUNT];
     
     PerfMonitor();
     
@@ -44,12 +89,28 @@ public:
     // Call after ImGui::Render() to capture draw stats
     void endFrame(ImDrawData* drawData);
     
+    // Publish per-component geometry counts (e.g. ChartRenderer::getDrawStats())
+    void setComponentStats(const DrawComponentStats* stats, int count);
+    
+    // Call right after the buffer swap to close tick-to-screen latency samples
+    void onPresent();
+    LatencyTracker& getLatencyTracker() { return m_latency; }
+    
+    // Bracket a section of the main loop (zones may not nest)
+    void beginZone(PerfZone zone);
+    void endZone(PerfZone zone);
+    
     // Get current stats
     const PerfStats& getStats() const { return m_stats; }
     
-    // Render the performance window
-    void renderWindow(float windowPosY, float windowHeight, float windowWidth, 
-                      float ticksPerSecond, int candleCount, int maxCandles);
+    // Spike log (index 0 = most recent)
+    void setSpikeThreshold(float ms) { m_spikeThresholdMs = ms; }
+    float getSpikeThreshold() const { return m_spikeThresholdMs; }
+    int getSpikeCount() const { return m_spikeLogCount; }
+    const SpikeRecord& getSpike(int index) const;
+    
+    // Render the performance window (registered metrics are listed automatically)
+    void renderWindow(float windowPosY, float windowHeight, float windowWidth);
     
 private:
     PerfStats m_stats;
@@ -60,5 +121,48 @@ private:
     int m_frameTimeHistoryIdx;
     bool m_initialized;
     
+    // Frames rejected by the delta time sanity check
+    Metric* m_framesSkipped;
+    
+    // Fill cost regression metrics
+    Metric* m_coveredPixels;
+    Metric* m_overdraw;
+    Metric* m_textureChanges;
+    Metric* m_clipRectChanges;
+    bool m_showDrawLists;
+    
+    // Tick-to-screen latency
+    LatencyTracker m_latency;
+    
+    // Zone timing for the frame in flight
+    SpikeRecord m_frame;
+    double m_frameStartMs;
+    double m_zoneStartMs;
+    int m_frameIndex;
+    Metric* m_ticksIngested;
+    Metric* m_candleCount;
+    
+    // Memory budget (see memory_budget.h; 0 when none is set)
+    Metric* m_memoryUsed;
+    Metric* m_memoryBudget;
+    
+    // Tick overload policy (see tick_policy.h)
+    Metric* m_tickPolicy;
+    Metric* m_tickPolicyWindow;
+    Metric* m_ticksConflated;
+    Metric* m_ticksDropped;
+    int64_t m_ticksAtFrameStart;
+    
+    // Bounded spike log (ring buffer)
+    float m_spikeThresholdMs;
+    SpikeRecord m_spikeLog[SPIKE_LOG_SIZE];
+    int m_spikeLogHead;
+    int m_spikeLogCount;
+    bool m_showSpikeLog;
+    
     void updateJitter();
+    void checkSpike(double nowMs);
+    void renderMetrics();
+    void renderSpikeLog();
+    void renderDrawLists();
 };
@@ -0,0 +1,386 @@
+#include "job_system.h"
+#include "platform.h"
+#if JOB_SYSTEM_THREADS
+#include <chrono>
+#endif
+
+// Idle workers re-check the queues at least this often (deferred jobs)
+static const int IDLE_WAIT_MS = 10;
+
+// Worker identity of the calling thread (-1: not a worker)
+static thread_local const JobSystem* t_owner = nullptr;
+static thread_local int t_workerIndex = -1;
+
+// ============================================================================
+// WORK DEQUE
+// ============================================================================
+
+WorkDeque::WorkDeque()
+    : m_top(0)
+    , m_bottom(0)
+{
+    for (int i = 0; i < CAPACITY; i++)
+        m_slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool WorkDeque::push(Job* job)
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= CAPACITY)
+        return false;
+    
+    m_slots[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    m_bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job* WorkDeque::pop()
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+    if (top > bottom)
+    {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    
+    Job* job = m_slots[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last job: thieves may be taking it too
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkDeque::steal()
+{
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+    
+    // The slot cannot be reused before top advances, so reading it first is safe
+    Job* job = m_slots[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+// ============================================================================
+// JOB QUEUE
+// ============================================================================
+
+void JobQueue::push(Job* job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs[job->priority].push_back(job);
+}
+
+Job* JobQueue::pop(JobPriority lowest)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int p = JOB_HIGH; p <= lowest; p++)
+    {
+        if (!m_jobs[p].empty())
+        {
+            Job* job = m_jobs[p].front();
+            m_jobs[p].pop_front();
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+int JobQueue::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int total = 0;
+    for (int p = 0; p < JOB_PRIORITY_COUNT; p++)
+        total += (int)m_jobs[p].size();
+    return total;
+}
+
+int JobQueue::size(JobPriority priority) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)m_jobs[priority].size();
+}
+
+// ============================================================================
+// JOB SYSTEM
+// ============================================================================
+
+JobSystem::JobSystem()
+    : m_workerCount(0)
+    , m_running(false)
+    , m_queued(0)
+#if JOB_SYSTEM_THREADS
+    , m_signal(0)
+#endif
+    , m_frameBudgetMs(DEFAULT_BUDGET_MS)
+    , m_frameStartMs(0.0)
+    , m_frameLate(false)
+    , m_latencySumUs(0)
+    , m_latencyCount(0)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_completed = metrics.rate("jobs.completed");
+    m_stolen = metrics.counter("jobs.stolen");
+    m_deferred = metrics.counter("jobs.deferred");
+    m_queueDepth = metrics.gauge("jobs.queued");
+    m_latencyMs = metrics.gauge("jobs.latency_ms");
+}
+
+JobSystem::~JobSystem()
+{
+    stop();
+}
+
+int JobSystem::start(int workers)
+{
+#if JOB_SYSTEM_THREADS
+    if (m_workerCount > 0 || workers <= 0)
+        return m_workerCount;
+    
+    m_workerCount = workers < MAX_WORKERS ? workers : MAX_WORKERS;
+    m_running.store(true);
+    for (int i = 0; i < m_workerCount; i++)
+        m_workers[i] = std::thread(&JobSystem::workerMain, this, i);
+#else
+    (void)workers;
+#endif
+    return m_workerCount;
+}
+
+void JobSystem::stop()
+{
+#if JOB_SYSTEM_THREADS
+    if (m_workerCount > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_running.store(false);
+        }
+        m_wake.notify_all();
+        for (int i = 0; i < m_workerCount; i++)
+            m_workers[i].join();
+        
+        for (int i = 0; i < m_workerCount; i++)
+        {
+            while (Job* job = m_deques[i].pop())
+                delete job;
+        }
+        m_workerCount = 0;
+    }
+#endif
+
+    while (Job* job = m_shared.pop(JOB_LOW))
+        delete job;
+    while (Job* job = m_main.pop(JOB_LOW))
+        delete job;
+    m_queued.store(0);
+}
+
+Job* JobSystem::makeJob(JobFn fn, void* user, JobPriority priority, JobCounter* counter)
+{
+    Job* job = new Job();
+    job->fn = fn;
+    job->user = user;
+    job->priority = priority;
+    job->counter = counter;
+    job->submitMs = platformNowMs();
+    if (counter)
+        counter->fetch_add(1, std::memory_order_relaxed);
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::submit(JobFn fn, void* user, JobPriority priority, JobCounter* counter)
+{
+    Job* job = makeJob(fn, user, priority, counter);
+    if (m_workerCount == 0)
+    {
+        m_main.push(job);
+        return;
+    }
+    
+    // Workers keep what they spawn (stolen when others run dry)
+    if (t_owner != this || t_workerIndex < 0 || !m_deques[t_workerIndex].push(job))
+        m_shared.push(job);
+    signal();
+}
+
+void JobSystem::submitMain(JobFn fn, void* user, JobPriority priority)
+{
+    m_main.push(makeJob(fn, user, priority, nullptr));
+}
+
+void JobSystem::beginFrame()
+{
+    double nowMs = platformNowMs();
+    bool late = m_frameStartMs > 0.0 && nowMs - m_frameStartMs > m_frameBudgetMs * LATE_FACTOR;
+    bool wasLate = m_frameLate.exchange(late, std::memory_order_relaxed);
+    m_frameStartMs = nowMs;
+    
+    int64_t count = m_latencyCount.exchange(0, std::memory_order_relaxed);
+    int64_t sumUs = m_latencySumUs.exchange(0, std::memory_order_relaxed);
+    if (count > 0)
+        m_latencyMs->set(sumUs / 1000.0 / count);
+    m_queueDepth->set(m_queued.load(std::memory_order_relaxed));
+    
+    // Deferred low-priority jobs may run again
+    if (wasLate && !late && m_workerCount > 0)
+        signal();
+}
+
+double JobSystem::getRemainingMs() const
+{
+    return m_frameBudgetMs - (platformNowMs() - m_frameStartMs);
+}
+
+bool JobSystem::isFrameLate() const
+{
+    return m_frameLate.load(std::memory_order_relaxed) || getRemainingMs() < 0.0;
+}
+
+int JobSystem::runMain()
+{
+    int available = m_main.size();
+    int ran = 0;
+    bool heldBack = false;
+    while (ran < available)
+    {
+        // The first job always runs (progress on slow devices), the rest
+        // only while budget remains
+        JobPriority lowest = JOB_HIGH;
+        if (ran == 0 || getRemainingMs() > 0.0)
+        {
+            lowest = isFrameLate() ? JOB_NORMAL : JOB_LOW;
+            heldBack |= lowest == JOB_NORMAL;
+        }
+        
+        Job* job = m_main.pop(lowest);
+        if (!job)
+            break;
+        run(job);
+        ran++;
+    }
+    
+    // Budget used up is not a deferral; lateness keeping LOW jobs back is
+    if (heldBack && m_main.size(JOB_LOW) > 0)
+        m_deferred->add();
+    return ran;
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    int worker = t_owner == this ? t_workerIndex : -1;
+    while (counter.load(std::memory_order_acquire) > 0)
+    {
+        Job* job = m_workerCount > 0 ? findJob(worker) : m_main.pop(JOB_LOW);
+        if (job)
+            run(job);
+        else if (m_workerCount == 0)
+            break;      // Nothing left that could finish the group
+#if JOB_SYSTEM_THREADS
+        else
+            std::this_thread::yield();
+#endif
+    }
+}
+
+Job* JobSystem::findJob(int worker)
+{
+    bool late = m_frameLate.load(std::memory_order_relaxed);
+    
+    // Own deque first (newest, still warm in cache)
+    if (worker >= 0)
+    {
+        while (Job* job = m_deques[worker].pop())
+        {
+            if (!late || job->priority != JOB_LOW)
+                return job;
+            m_shared.push(job);
+            m_deferred->add();
+        }
+    }
+    
+    if (Job* job = m_shared.pop(late ? JOB_NORMAL : JOB_LOW))
+        return job;
+    
+    // Steal the oldest job of another worker
+    for (int i = 1; i <= m_workerCount; i++)
+    {
+        int victim = (worker + i + m_workerCount) % m_workerCount;
+        if (victim == worker)
+            continue;
+        
+        Job* job = m_deques[victim].steal();
+        if (!job)
+            continue;
+        m_stolen->add();
+        if (!late || job->priority != JOB_LOW)
+            return job;
+        m_shared.push(job);
+        m_deferred->add();
+    }
+    return nullptr;
+}
+
+void JobSystem::run(Job* job)
+{
+    double startMs = platformNowMs();
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    m_latencySumUs.fetch_add((int64_t)((startMs - job->submitMs) * 1000.0), std::memory_order_relaxed);
+    m_latencyCount.fetch_add(1, std::memory_order_relaxed);
+    
+    job->fn(job->user);
+    
+    if (job->counter)
+        job->counter->fetch_sub(1, std::memory_order_release);
+    delete job;
+    m_completed->add();
+}
+
+void JobSystem::signal()
+{
+#if JOB_SYSTEM_THREADS
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_signal.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_wake.notify_one();
+#endif
+}
+
+void JobSystem::workerMain(int index)
+{
+#if JOB_SYSTEM_THREADS
+    t_owner = this;
+    t_workerIndex = index;
+    
+    while (m_running.load())
+    {
+        uint64_t seen = m_signal.load();
+        Job* job = findJob(index);
+        if (job)
+        {
+            run(job);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS),
+                        [&]() { return m_signal.load() != seen || !m_running.load(); });
+    }
+#else
+    (void)index;
+#endif
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "../perf/metrics.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+
+// Worker threads are available natively and in WASM builds linked with -pthread
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define JOB_SYSTEM_THREADS 1
+#include <condition_variable>
+#include <thread>
+#else
+#define JOB_SYSTEM_THREADS 0
+#endif
+
+// ============================================================================
+// JOB SYSTEM
+// One place to run expensive non-render work (imports, history rebuilds,
+// derived data) without blocking frames.
+//
+// Threaded builds start worker threads, each with a work-stealing deque:
+// jobs a worker submits go to its own deque (newest first), idle workers
+// steal the oldest from others, and jobs submitted from other threads go
+// through a shared FIFO. Without threads (plain WASM) every job runs
+// cooperatively on the render thread in runMain(), inside what is left of
+// the frame budget. Jobs that must stay on the render thread (e.g. ones
+// waiting for browser fetch callbacks) use submitMain() in both modes.
+//
+// The render thread marks frames with beginFrame(); a frame that overran
+// the budget is late, and low-priority jobs wait until frames are on time
+// again. Jobs longer than a frame should do a slice and resubmit themselves.
+// Queue depth and submit-to-start latency go to the metrics registry
+// (jobs.*), which PerfMonitor lists.
+// ============================================================================
+
+enum JobPriority
+{
+    JOB_HIGH,           // Runs even in a late frame
+    JOB_NORMAL,         // Cooperative: at least one per frame, more while budget remains
+    JOB_LOW,            // Deferred while frames are late
+    JOB_PRIORITY_COUNT
+};
+
+typedef void (*JobFn)(void* user);
+
+// Outstanding jobs of a group: submit() increments, completion decrements
+typedef std::atomic<int> JobCounter;
+
+struct Job
+{
+    JobFn fn;
+    void* user;
+    JobPriority priority;
+    JobCounter* counter;
+    double submitMs;
+};
+
+// Fixed-capacity Chase-Lev deque: the owner pushes and pops at the bottom,
+// any thread steals from the top
+class WorkDeque
+{
+public:
+    static const int CAPACITY = 1024;
+    
+    WorkDeque();
+    
+    bool push(Job* job);    // Owner; false when full
+    Job* pop();             // Owner; newest
+    Job* steal();           // Any thread; oldest (nullptr when empty or lost a race)
+    
+private:
+    std::atomic<int64_t> m_top;
+    std::atomic<int64_t> m_bottom;
+    std::atomic<Job*> m_slots[CAPACITY];
+};
+
+// Locked FIFO per priority
+class JobQueue
+{
+public:
+    void push(Job* job);
+    Job* pop(JobPriority lowest);   // Highest priority first, none below `lowest`
+    int size() const;
+    int size(JobPriority priority) const;
+    
+private:
+    mutable std::mutex m_mutex;
+    std::deque<Job*> m_jobs[JOB_PRIORITY_COUNT];
+};
+
+class JobSystem
+{
+public:
+    static const int MAX_WORKERS = 8;
+    static constexpr double LATE_FACTOR = 1.5;      // Frame interval over budget * this is late
+    static constexpr double DEFAULT_BUDGET_MS = 1000.0 / 60.0;
+    
+    JobSystem();
+    ~JobSystem();
+    
+    // Start up to `workers` threads; returns the number started (0: built
+    // without threads or workers == 0, jobs then run in runMain())
+    int start(int workers);
+    
+    // Join the workers; jobs still queued are discarded
+    void stop();
+    bool isThreaded() const { return m_workerCount > 0; }
+    
+    // Any thread, including from inside a job
+    void submit(JobFn fn, void* user, JobPriority priority = JOB_NORMAL, JobCounter* counter = nullptr);
+    void submitMain(JobFn fn, void* user, JobPriority priority = JOB_NORMAL);
+    
+    // Render thread: frame budget and lateness
+    void setFrameBudget(double ms) { m_frameBudgetMs = ms; }
+    void beginFrame();
+    double getRemainingMs() const;
+    bool isFrameLate() const;
+    
+    // Render thread, once per frame (after present): run main-thread jobs,
+    // and every job when cooperative, within the remaining budget. Jobs
+    // submitted meanwhile wait for the next frame. Returns the number run.
+    int runMain();
+    
+    // Run jobs on the calling thread until the counter drops to zero
+    void wait(JobCounter& counter);
+    
+    int getQueueDepth() const { return m_queued.load(std::memory_order_relaxed); }
+    
+private:
+    int m_workerCount;
+    std::atomic<bool> m_running;
+    std::atomic<int> m_queued;
+    
+    WorkDeque m_deques[MAX_WORKERS];
+    JobQueue m_shared;      // Submitted from outside the workers, and deferred low-priority jobs
+    JobQueue m_main;        // Render thread only
+    
+#if JOB_SYSTEM_THREADS
+    std::thread m_workers[MAX_WORKERS];
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<uint64_t> m_signal;     // Bumped per submission; idle workers wait for a change
+#endif
+
+    // Frame state (written by the render thread)
+    double m_frameBudgetMs;
+    double m_frameStartMs;
+    std::atomic<bool> m_frameLate;
+    
+    // Submit-to-start latency since the last beginFrame()
+    std::atomic<int64_t> m_latencySumUs;
+    std::atomic<int64_t> m_latencyCount;
+    
+    Metric* m_completed;
+    Metric* m_stolen;
+    Metric* m_deferred;
+    Metric* m_queueDepth;
+    Metric* m_latencyMs;
+    
+    Job* makeJob(JobFn fn, void* user, JobPriority priority, JobCounter* counter);
+    Job* findJob(int worker);
+    void run(Job* job);
+    void signal();
+    void workerMain(int index);
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// PLATFORM LAYER
+// The few services that differ between the WASM and native builds:
+// monotonic clock, heap statistics, the main loop driver and random access
+// to large read-only files
+// ============================================================================
+
+typedef void (*MainLoopFn)();
+
+// Monotonic clock in milliseconds (arbitrary epoch)
+double platformNowMs();
+
+// Bytes currently reserved by the heap
+size_t platformHeapSize();
+
+// Run the main loop. WASM: hands the loop to requestAnimationFrame and never
+// returns. Native: calls fn back-to-back until platformRequestQuit().
+void platformRunMainLoop(MainLoopFn fn);
+void platformRequestQuit();
+
+// Read-only random access to large files. Native: memory-mapped, reads
+// complete inside platformFileRead(). WASM: `path` is a URL on the page's
+// server, reads are HTTP Range requests that complete later on the main
+// thread. Close a file only once no reads are in flight.
+struct PlatformFile;
+
+// Read completion; data is valid only during the call (nullptr on failure)
+typedef void (*PlatformReadFn)(void* user, const void* data, size_t size);
+
+PlatformFile* platformFileOpen(const char* path);  // nullptr when it cannot be opened
+void platformFileRead(PlatformFile* file, uint64_t offset, size_t size, PlatformReadFn done, void* user);
+
+// Streaming read of up to maxSize bytes: fewer means the end of the file was
+// reached (size 0 with non-null data at or past it)
+void platformFileReadSome(PlatformFile* file, uint64_t offset, size_t maxSize, PlatformReadFn done, void* user);
+void platformFilePrefetch(PlatformFile* file, uint64_t offset, size_t size);  // Readahead hint (native)
+void platformFileClose(PlatformFile* file);
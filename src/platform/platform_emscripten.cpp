@@ -0,0 +1,137 @@
+#include "platform.h"
+#include <emscripten.h>
+#include <emscripten/heap.h>
+#include <emscripten/fetch.h>
+#include <stdio.h>
+#include <string.h>
+
+double platformNowMs()
+{
+    return emscripten_get_now();
+}
+
+size_t platformHeapSize()
+{
+    return emscripten_get_heap_size();
+}
+
+void platformRunMainLoop(MainLoopFn fn)
+{
+    // 0 = use requestAnimationFrame, 1 = simulate infinite loop
+    emscripten_set_main_loop(fn, 0, 1);
+}
+
+void platformRequestQuit()
+{
+    emscripten_cancel_main_loop();
+}
+
+// Linked with -s FETCH=1
+struct PlatformFile
+{
+    char url[256];
+};
+
+struct PlatformRead
+{
+    PlatformReadFn done;
+    void* user;
+    uint64_t offset;
+    size_t size;
+    bool partial;   // platformFileReadSome: a short body is the end of file
+};
+
+// Non-null data of an empty read at the end of a file
+static const char EMPTY_READ = 0;
+
+static void onFetchSuccess(emscripten_fetch_t* fetch)
+{
+    PlatformRead* read = (PlatformRead*)fetch->userData;
+    
+    // 206 carries the range; a server without Range support sends the whole file
+    uint64_t skip = fetch->status == 200 ? read->offset : 0;
+    if (fetch->numBytes >= skip + read->size)
+        read->done(read->user, fetch->data + skip, read->size);
+    else if (read->partial)
+        read->done(read->user, fetch->data + skip, fetch->numBytes > skip ? (size_t)(fetch->numBytes - skip) : 0);
+    else
+        read->done(read->user, nullptr, 0);
+    
+    delete read;
+    emscripten_fetch_close(fetch);
+}
+
+static void onFetchError(emscripten_fetch_t* fetch)
+{
+    PlatformRead* read = (PlatformRead*)fetch->userData;
+    
+    // 416: the range starts at or past the end of the file
+    if (read->partial && fetch->status == 416)
+        read->done(read->user, &EMPTY_READ, 0);
+    else
+        read->done(read->user, nullptr, 0);
+    delete read;
+    emscripten_fetch_close(fetch);
+}
+
+PlatformFile* platformFileOpen(const char* path)
+{
+    // Existence is only known once the first read answers
+    PlatformFile* file = new PlatformFile();
+    snprintf(file->url, sizeof(file->url), "%s", path);
+    return file;
+}
+
+static void startRead(PlatformFile* file, uint64_t offset, size_t size, bool partial, PlatformReadFn done, void* user)
+{
+    PlatformRead* read = new PlatformRead();
+    read->done = done;
+    read->user = user;
+    read->offset = offset;
+    read->size = size;
+    read->partial = partial;
+    
+    char range[64];
+    snprintf(range, sizeof(range), "bytes=%llu-%llu", (unsigned long long)offset, (unsigned long long)(offset + size - 1));
+    const char* headers[] = { "Range", range, nullptr };
+    
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    strcpy(attr.requestMethod, "GET");
+    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+    attr.requestHeaders = headers;
+    attr.userData = read;
+    attr.onsuccess = onFetchSuccess;
+    attr.onerror = onFetchError;
+    emscripten_fetch(&attr, file->url);
+}
+
+void platformFileRead(PlatformFile* file, uint64_t offset, size_t size, PlatformReadFn done, void* user)
+{
+    if (size == 0)
+    {
+        done(user, nullptr, 0);
+        return;
+    }
+    startRead(file, offset, size, false, done, user);
+}
+
+void platformFileReadSome(PlatformFile* file, uint64_t offset, size_t maxSize, PlatformReadFn done, void* user)
+{
+    if (maxSize == 0)
+    {
+        done(user, &EMPTY_READ, 0);
+        return;
+    }
+    startRead(file, offset, maxSize, true, done, user);
+}
+
+void platformFilePrefetch(PlatformFile*, uint64_t, size_t)
+{
+    // Nothing to hint: callers prefetch by issuing reads early
+}
+
+void platformFileClose(PlatformFile* file)
+{
+    delete file;
+}
@@ -0,0 +1,101 @@
+#include "platform.h"
+#include <time.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static volatile bool g_QuitRequested = false;
+
+double platformNowMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+size_t platformHeapSize()
+{
+    // Main arena plus mmapped chunks, comparable to the WASM heap size
+    struct mallinfo2 info = mallinfo2();
+    return info.arena + info.hblkhd;
+}
+
+void platformRunMainLoop(MainLoopFn fn)
+{
+    g_QuitRequested = false;
+    while (!g_QuitRequested)
+    {
+        fn();
+    }
+}
+
+void platformRequestQuit()
+{
+    g_QuitRequested = true;
+}
+
+struct PlatformFile
+{
+    const unsigned char* data;
+    size_t size;
+};
+
+PlatformFile* platformFileOpen(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file alive
+    if (data == MAP_FAILED)
+        return nullptr;
+    
+    PlatformFile* file = new PlatformFile();
+    file->data = (const unsigned char*)data;
+    file->size = st.st_size;
+    return file;
+}
+
+void platformFileRead(PlatformFile* file, uint64_t offset, size_t size, PlatformReadFn done, void* user)
+{
+    // Zero-copy: the callback reads the mapping (page faults pull the data in)
+    if (offset > file->size || size > file->size - offset)
+        done(user, nullptr, 0);
+    else
+        done(user, file->data + offset, size);
+}
+
+void platformFileReadSome(PlatformFile* file, uint64_t offset, size_t maxSize, PlatformReadFn done, void* user)
+{
+    if (offset > file->size)
+        offset = file->size;
+    size_t size = maxSize < file->size - offset ? maxSize : (size_t)(file->size - offset);
+    done(user, file->data + offset, size);
+}
+
+void platformFilePrefetch(PlatformFile* file, uint64_t offset, size_t size)
+{
+    // Asynchronous kernel readahead, so the later read does not block on disk
+    if (offset >= file->size)
+        return;
+    if (size > file->size - offset)
+        size = file->size - offset;
+    
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = offset & ~(page - 1);
+    madvise((void*)(file->data + start), size + (offset - start), MADV_WILLNEED);
+}
+
+void platformFileClose(PlatformFile* file)
+{
+    if (!file)
+        return;
+    munmap((void*)file->data, file->size);
+    delete file;
+}